@@ -78,7 +78,6 @@ void Avatar::init() {
 
 	stats.cooldown_ticks = 0;
 	
-	haz = NULL;
 
 	img_main = "";
 	img_armor = "";
@@ -102,12 +101,11 @@ void Avatar::loadGraphics(string _img_main, string _img_armor, string _img_off)
 		img_off = _img_off;
 	
 		// composite the hero graphic
-		if (sprites) SDL_FreeSurface(sprites);
-		sprites = IMG_Load(("images/avatar/male/" + img_armor + ".png").c_str());
+		SDL_Surface *sheet = IMG_Load(("images/avatar/male/" + img_armor + ".png").c_str());
 		if (img_main != "") gfx_main = IMG_Load(("images/avatar/male/" + img_main + ".png").c_str());
 		if (img_off != "") gfx_off = IMG_Load(("images/avatar/male/" + img_off + ".png").c_str());
 
-		SDL_SetColorKey( sprites, SDL_SRCCOLORKEY, SDL_MapRGB(sprites->format, 255, 0, 255) ); 
+		SDL_SetColorKey( sheet, SDL_SRCCOLORKEY, SDL_MapRGB(sheet->format, 255, 0, 255) ); 
 		if (gfx_main) SDL_SetColorKey( gfx_main, SDL_SRCCOLORKEY, SDL_MapRGB(gfx_main->format, 255, 0, 255) ); 
 		if (gfx_off) SDL_SetColorKey( gfx_off, SDL_SRCCOLORKEY, SDL_MapRGB(gfx_off->format, 255, 0, 255) ); 
 		
@@ -116,23 +114,23 @@ void Avatar::loadGraphics(string _img_main, string _img_armor, string _img_off)
 		src.h = dest.h = 256;
 		src.x = dest.x = 0;
 		src.y = dest.y = 0;
-		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sprites, &dest);
+		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sheet, &dest);
 		src.y = dest.y = 768;
-		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sprites, &dest);
+		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sheet, &dest);
 		src.h = dest.h = 1024;
 		src.y = dest.y = 0;
-		if (gfx_off) SDL_BlitSurface(gfx_off, &src, sprites, &dest);
+		if (gfx_off) SDL_BlitSurface(gfx_off, &src, sheet, &dest);
 		src.h = dest.h = 512;
 		src.y = dest.y = 256;
-		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sprites, &dest);
+		if (gfx_main) SDL_BlitSurface(gfx_main, &src, sheet, &dest);
 		
 		if (gfx_main) SDL_FreeSurface(gfx_main);
 		if (gfx_off) SDL_FreeSurface(gfx_off);
 		
-		// optimize
-		SDL_Surface *cleanup = sprites;
-		sprites = SDL_DisplayFormatAlpha(sprites);
-		SDL_FreeSurface(cleanup);
+		// trim the animation frames and pack them
+		delete sprites;
+		sprites = new SpriteAtlas();
+		sprites->pack(sheet, 128, 128, "images/avatar/male/" + img_armor + ".png");
 	}
 }
 
@@ -209,6 +207,13 @@ void Avatar::set_direction() {
 	// handle direction changes
 	if(MOUSE_MOVE) {
 		Point target = screen_to_map(inp->mouse.x,  inp->mouse.y, stats.pos.x, stats.pos.y);
+		
+		// walk around obstacles instead of into them
+		if (!map->collider.line_of_movement(stats.pos.x, stats.pos.y, target.x, target.y)) {
+			Point waypoint;
+			if (map->pathfinder.findPath(stats.pos, target, waypoint) == PATH_FOUND)
+				target = waypoint;
+		}
 		stats.direction = face(target.x, target.y);
 	} else {
 		if(inp->pressing[UP] && inp->pressing[LEFT]) stats.direction = 1;
@@ -286,7 +291,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 		ss << "Congratulations, you have reached level " << stats.level << "! You may increase one attribute through the Character Menu.";
 		log_msg = ss.str();
 		stats.recalc();
-		Mix_PlayChannel(-1, level_up, 0);
+		sound_queue.play(level_up);
 	}
 
 	// check for bleeding spurt
@@ -410,7 +415,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			stepfx = rand() % 4;
 			
 			if (stats.cur_frame == 0 || stats.cur_frame == max_frame/2) {
-				Mix_PlayChannel(-1, sound_steps[stepfx], 0);
+				sound_queue.play(sound_steps[stepfx]);
 			}
 
 			// allowed to move or use powers?
@@ -499,7 +504,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			stats.disp_frame = (stats.cur_frame / stats.anim_melee_duration) + stats.anim_melee_position;
 			
 			if (stats.cur_frame == 1) {
-				Mix_PlayChannel(-1, sound_melee, 0);
+				sound_queue.play(sound_melee);
 			}
 			
 			// do power
@@ -592,7 +597,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			stats.disp_frame = (stats.cur_frame / stats.anim_die_duration) + stats.anim_die_position;
 
 			if (stats.cur_frame == 1) {
-				Mix_PlayChannel(-1, sound_die, 0);
+				sound_queue.play(sound_die);
 				log_msg = "You are defeated.  You lose half your gold.  Press Enter to continue.";
 			}
 			
@@ -628,15 +633,14 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 	map->hero_tile.x = stats.pos.x / 32;
 	map->hero_tile.y = stats.pos.y / 32;
 	
-	// check for map events
-	map->checkEvents(stats.pos);
+	// map events are checked by GameEngine once the world tick is done
 }
 
 /**
  * Called by HazardManager
  * Return false on a miss
  */
-bool Avatar::takeHit(Hazard h) {
+bool Avatar::takeHit(const Hazard &h) {
 
 	if (stats.cur_state != AVATAR_DEAD) {
 	
@@ -675,7 +679,7 @@ bool Avatar::takeHit(Hazard h) {
 			if (dmg < 1 && !stats.blocking) dmg = 1; // when blocking, dmg can be reduced to 0
 			if (dmg <= 0) {
 				dmg = 0;
-				Mix_PlayChannel(-1, sound_block, 0);
+				sound_queue.play(sound_block);
 				stats.cur_frame = 0; // shield stutter
 			}
 			
@@ -716,7 +720,7 @@ bool Avatar::takeHit(Hazard h) {
 			stats.death_penalty = true;
 		}
 		else if (prev_hp > stats.hp) { // only interrupt if damage was taken
-			Mix_PlayChannel(-1, sound_hit, 0);
+			sound_queue.play(sound_hit);
 			stats.cur_frame = 0;
 			stats.disp_frame = 18;
 			stats.cur_state = AVATAR_HIT;
@@ -736,7 +740,7 @@ Renderable Avatar::getRender() {
 	Renderable r;
 	r.map_pos.x = stats.pos.x;
 	r.map_pos.y = stats.pos.y;
-	r.sprite = sprites;
+	r.sprite = NULL;
 	r.src.x = 128 * stats.disp_frame;
 	r.src.y = 128 * stats.direction;
 	r.src.w = 128;
@@ -744,11 +748,13 @@ Renderable Avatar::getRender() {
 	r.offset.x = 64;
 	r.offset.y = 96; // 112
 	r.object_layer = true;
+	r.flip = false;
+	if (sprites) sprites->lookup(r);
 	return r;	
 }
 
 Avatar::~Avatar() {
-	SDL_FreeSurface(sprites);
+	delete sprites;
 	Mix_FreeChunk(sound_melee);
 	Mix_FreeChunk(sound_hit);
 	Mix_FreeChunk(sound_die);
@@ -758,6 +764,4 @@ Avatar::~Avatar() {
 	Mix_FreeChunk(sound_steps[2]);
 	Mix_FreeChunk(sound_steps[3]);
 	Mix_FreeChunk(level_up);
-			
-	delete haz;	
 }
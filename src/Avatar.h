@@ -21,6 +21,8 @@
 #include "StatBlock.h"
 #include "Hazard.h"
 #include "PowerManager.h"
+#include "SpriteAtlas.h"
+#include "SoundQueue.h"
 
 // AVATAR State enum
 const int AVATAR_STANCE = 0;
@@ -39,7 +41,7 @@ private:
 	InputState *inp;
 	MapIso *map;
 	
-	SDL_Surface *sprites;
+	SpriteAtlas *sprites;
 
 	bool lockSwing;
 	bool lockCast;
@@ -71,12 +73,11 @@ public:
 	void set_direction();
 	int face(int mapx, int mapy);
 	Renderable getRender();
-	bool takeHit(Hazard h);
+	bool takeHit(const Hazard &h);
 	string log_msg;
 	
 	// vars
 	StatBlock stats;
-	Hazard *haz;
 	int current_power;
 	Point act_target;
 	bool drag_walking;
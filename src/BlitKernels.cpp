@@ -0,0 +1,405 @@
+/**
+ * BlitKernels
+ *
+ * Drop-in replacements for SDL_BlitSurface and SDL_LowerBlit with
+ * dedicated loops for the blits the engine does every frame.
+ * The SSE2 loops handle four pixels at a time; the scalar loops finish
+ * each row and stand in on builds without SSE2.
+ *
+ * @license GPL
+ */
+
+#include "BlitKernels.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Which loop handles a blit from src to dst.
+ * Only formats where SDL's result is known exactly are taken over.
+ */
+int blitKernel(SDL_Surface *src, SDL_Surface *dst) {
+	SDL_PixelFormat *sf = src->format;
+	SDL_PixelFormat *df = dst->format;
+	
+	if (sf->BytesPerPixel != 4 || df->BytesPerPixel != 4) return BLIT_KERNEL_SDL;
+	if (SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst)) return BLIT_KERNEL_SDL;
+	if (sf->Rmask != df->Rmask || sf->Gmask != df->Gmask || sf->Bmask != df->Bmask) return BLIT_KERNEL_SDL;
+	
+	// per-pixel alpha ignores the colorkey and the surface alpha
+	if (src->flags & SDL_SRCALPHA) {
+		if (sf->Amask == 0xff000000) return BLIT_KERNEL_ALPHA;
+		return BLIT_KERNEL_SDL;
+	}
+	
+	if ((src->flags & SDL_SRCCOLORKEY) && sf->Amask == 0 && df->Amask == 0)
+		return BLIT_KERNEL_COLORKEY;
+	
+	return BLIT_KERNEL_SDL;
+}
+
+/**
+ * SDL's RGB to RGB per-pixel alpha blend: the destination alpha byte is kept,
+ * alpha 255 copies and anything else is d + (s - d) * a / 256, rounded down.
+ * That is (d * (256 - a) + s * a) >> 8, which never leaves 16 bits.
+ */
+static inline Uint32 blendPixel(Uint32 s, Uint32 d) {
+	Uint32 a = s >> 24;
+	if (a == 0) return d;
+	if (a == 255) return (s & 0x00ffffff) | (d & 0xff000000);
+	
+	Uint32 s1 = s & 0xff00ff;
+	Uint32 d1 = d & 0xff00ff;
+	d1 = (d1 + ((s1 - d1) * a >> 8)) & 0xff00ff;
+	s &= 0xff00;
+	Uint32 d2 = d & 0xff00;
+	d2 = (d2 + ((s - d2) * a >> 8)) & 0xff00;
+	return d1 | d2 | (d & 0xff000000);
+}
+
+static void blendRow(Uint32 *s, Uint32 *d, int w) {
+	int x = 0;
+	
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(256);
+	const __m128i opaque = _mm_set1_epi32(0xff);
+	const __m128i rgb = _mm_set1_epi32(0x00ffffff);
+	
+	for (; x + 4 <= w; x += 4) {
+		__m128i sp = _mm_loadu_si128((__m128i *)(s + x));
+		__m128i alpha = _mm_srli_epi32(sp, 24);
+		
+		// skip runs of fully transparent pixels
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xffff) continue;
+		
+		__m128i dp = _mm_loadu_si128((__m128i *)(d + x));
+		
+		__m128i s_lo = _mm_unpacklo_epi8(sp, zero);
+		__m128i s_hi = _mm_unpackhi_epi8(sp, zero);
+		__m128i d_lo = _mm_unpacklo_epi8(dp, zero);
+		__m128i d_hi = _mm_unpackhi_epi8(dp, zero);
+		
+		// copy each pixel's alpha into all four of its channels
+		__m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xff), 0xff);
+		__m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xff), 0xff);
+		
+		__m128i r_lo = _mm_add_epi16(_mm_mullo_epi16(d_lo, _mm_sub_epi16(full, a_lo)), _mm_mullo_epi16(s_lo, a_lo));
+		__m128i r_hi = _mm_add_epi16(_mm_mullo_epi16(d_hi, _mm_sub_epi16(full, a_hi)), _mm_mullo_epi16(s_hi, a_hi));
+		__m128i blended = _mm_packus_epi16(_mm_srli_epi16(r_lo, 8), _mm_srli_epi16(r_hi, 8));
+		
+		// opaque pixels are copied rather than blended
+		__m128i is_opaque = _mm_cmpeq_epi32(alpha, opaque);
+		blended = _mm_or_si128(_mm_and_si128(is_opaque, sp), _mm_andnot_si128(is_opaque, blended));
+		
+		__m128i result = _mm_or_si128(_mm_and_si128(blended, rgb), _mm_andnot_si128(rgb, dp));
+		_mm_storeu_si128((__m128i *)(d + x), result);
+	}
+#endif
+
+	for (; x < w; x++) {
+		d[x] = blendPixel(s[x], d[x]);
+	}
+}
+
+/**
+ * SDL's colorkey blit to a destination without alpha: every pixel that
+ * isn't the key is copied, with its alpha byte cleared.
+ */
+static void colorkeyRow(Uint32 *s, Uint32 *d, int w, Uint32 key, Uint32 rgb_mask) {
+	int x = 0;
+	
+#ifdef __SSE2__
+	const __m128i keys = _mm_set1_epi32(key);
+	const __m128i rgb = _mm_set1_epi32(rgb_mask);
+	
+	for (; x + 4 <= w; x += 4) {
+		__m128i sp = _mm_loadu_si128((__m128i *)(s + x));
+		__m128i dp = _mm_loadu_si128((__m128i *)(d + x));
+		__m128i keyed = _mm_cmpeq_epi32(sp, keys);
+		__m128i result = _mm_or_si128(_mm_and_si128(keyed, dp), _mm_andnot_si128(keyed, _mm_and_si128(sp, rgb)));
+		_mm_storeu_si128((__m128i *)(d + x), result);
+	}
+#endif
+
+	for (; x < w; x++) {
+		if (s[x] != key) d[x] = s[x] & rgb_mask;
+	}
+}
+
+/**
+ * Same contract as SDL_LowerBlit: both rects are already clipped
+ */
+int fastLowerBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect) {
+	int kernel = blitKernel(src, dst);
+	if (kernel == BLIT_KERNEL_SDL) return SDL_LowerBlit(src, srcrect, dst, dstrect);
+	
+	int w = srcrect->w;
+	int h = srcrect->h;
+	int src_pitch = src->pitch >> 2;
+	int dst_pitch = dst->pitch >> 2;
+	Uint32 *s = (Uint32 *)src->pixels + srcrect->y * src_pitch + srcrect->x;
+	Uint32 *d = (Uint32 *)dst->pixels + dstrect->y * dst_pitch + dstrect->x;
+	
+	if (kernel == BLIT_KERNEL_ALPHA) {
+		for (int y=0; y<h; y++) {
+			blendRow(s, d, w);
+			s += src_pitch;
+			d += dst_pitch;
+		}
+	}
+	else {
+		Uint32 key = src->format->colorkey;
+		Uint32 rgb_mask = dst->format->Rmask | dst->format->Gmask | dst->format->Bmask;
+		for (int y=0; y<h; y++) {
+			colorkeyRow(s, d, w, key, rgb_mask);
+			s += src_pitch;
+			d += dst_pitch;
+		}
+	}
+	return 0;
+}
+
+static Uint32 readPixel(Uint8 *p, int bpp) {
+	switch (bpp) {
+		case 1:
+			return *p;
+		case 2:
+			return *(Uint16 *)p;
+		case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			return (p[0] << 16) | (p[1] << 8) | p[2];
+#else
+			return p[0] | (p[1] << 8) | (p[2] << 16);
+#endif
+		default:
+			return *(Uint32 *)p;
+	}
+}
+
+static void writePixel(Uint8 *p, int bpp, Uint32 pixel) {
+	switch (bpp) {
+		case 1:
+			*p = pixel;
+			break;
+		case 2:
+			*(Uint16 *)p = pixel;
+			break;
+		case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			p[0] = pixel >> 16;
+			p[1] = pixel >> 8;
+			p[2] = pixel;
+#else
+			p[0] = pixel;
+			p[1] = pixel >> 8;
+			p[2] = pixel >> 16;
+#endif
+			break;
+		default:
+			*(Uint32 *)p = pixel;
+			break;
+	}
+}
+
+/**
+ * The 256 dst pixels an 8-bit palette source's entries draw as
+ */
+void mapPalette(SDL_Surface *src, SDL_Surface *dst, Uint32 *map) {
+	SDL_Palette *palette = src->format->palette;
+	for (int i=0; i<256; i++) {
+		map[i] = 0;
+		if (palette && i < palette->ncolors) {
+			SDL_Color *c = &palette->colors[i];
+			map[i] = SDL_MapRGB(dst->format, c->r, c->g, c->b);
+		}
+	}
+}
+
+/**
+ * Same contract as SDL_LowerBlit, but srcrect is drawn mirrored left to
+ * right: its rightmost column lands on the left edge of dstrect.
+ * Keys and blending are the same as for the unmirrored blit.
+ * For an 8-bit palette source, palette_map can pass in its mapPalette()
+ * table for dst; without it the palette is mapped on every call.
+ */
+int flipLowerBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, const Uint32 *palette_map) {
+	int w = srcrect->w;
+	int h = srcrect->h;
+	if (w <= 0 || h <= 0) return 0;
+	
+	if (SDL_MUSTLOCK(src) && SDL_LockSurface(src) < 0) return -1;
+	if (SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) < 0) {
+		if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
+		return -1;
+	}
+	
+	SDL_PixelFormat *sf = src->format;
+	SDL_PixelFormat *df = dst->format;
+	int last = srcrect->x + w - 1;
+	Uint8 *s_row = (Uint8 *)src->pixels + srcrect->y * src->pitch;
+	Uint8 *d_row = (Uint8 *)dst->pixels + dstrect->y * dst->pitch + dstrect->x * df->BytesPerPixel;
+	int kernel = blitKernel(src, dst);
+	
+	if (sf->BytesPerPixel == 1 && sf->palette && df->BytesPerPixel == 4 && !(src->flags & SDL_SRCALPHA)) {
+	
+		Uint32 own_map[256];
+		const Uint32 *map = palette_map;
+		if (!map) {
+			mapPalette(src, dst, own_map);
+			map = own_map;
+		}
+		int key = (src->flags & SDL_SRCCOLORKEY) ? (int)sf->colorkey : -1;
+		
+		for (int y=0; y<h; y++) {
+			Uint8 *s = s_row + last;
+			Uint32 *d = (Uint32 *)d_row;
+			for (int x=0; x<w; x++) {
+				int p = s[-x];
+				if (p != key) d[x] = map[p];
+			}
+			s_row += src->pitch;
+			d_row += dst->pitch;
+		}
+	}
+	else if (kernel != BLIT_KERNEL_SDL) {
+	
+		// mirror each row into a buffer, then run the straight loop over it
+		Uint32 buffer[BLIT_FLIP_CHUNK];
+		Uint32 key = sf->colorkey;
+		Uint32 rgb_mask = df->Rmask | df->Gmask | df->Bmask;
+		
+		for (int y=0; y<h; y++) {
+			Uint32 *s = (Uint32 *)s_row;
+			Uint32 *d = (Uint32 *)d_row;
+			for (int x=0; x<w; x+=BLIT_FLIP_CHUNK) {
+				int n = w - x;
+				if (n > BLIT_FLIP_CHUNK) n = BLIT_FLIP_CHUNK;
+				for (int i=0; i<n; i++) {
+					buffer[i] = s[last - x - i];
+				}
+				if (kernel == BLIT_KERNEL_ALPHA) blendRow(buffer, d + x, n);
+				else colorkeyRow(buffer, d + x, n, key, rgb_mask);
+			}
+			s_row += src->pitch;
+			d_row += dst->pitch;
+		}
+	}
+	else {
+	
+		// any other formats a pixel at a time, through SDL's color conversion
+		int sbpp = sf->BytesPerPixel;
+		int dbpp = df->BytesPerPixel;
+		bool pixel_alpha = (src->flags & SDL_SRCALPHA) && sf->Amask;
+		bool keyed = !pixel_alpha && (src->flags & SDL_SRCCOLORKEY);
+		Uint8 surface_alpha = (src->flags & SDL_SRCALPHA) ? sf->alpha : 255;
+		Uint8 r, g, b, a, dr, dg, db;
+		
+		for (int y=0; y<h; y++) {
+			for (int x=0; x<w; x++) {
+				Uint32 p = readPixel(s_row + (last - x) * sbpp, sbpp);
+				if (keyed && p == sf->colorkey) continue;
+				
+				SDL_GetRGBA(p, sf, &r, &g, &b, &a);
+				if (!pixel_alpha) a = surface_alpha;
+				if (a == 0) continue;
+				
+				Uint8 *d = d_row + x * dbpp;
+				if (a != 255) {
+					SDL_GetRGB(readPixel(d, dbpp), df, &dr, &dg, &db);
+					r = dr + ((r - dr) * a >> 8);
+					g = dg + ((g - dg) * a >> 8);
+					b = db + ((b - db) * a >> 8);
+				}
+				writePixel(d, dbpp, SDL_MapRGB(df, r, g, b));
+			}
+			s_row += src->pitch;
+			d_row += dst->pitch;
+		}
+	}
+	
+	if (SDL_MUSTLOCK(dst)) SDL_UnlockSurface(dst);
+	if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
+	return 0;
+}
+
+/**
+ * Same contract as SDL_BlitSurface: clips to the source and to the
+ * destination clip rect, and leaves the blitted area in dstrect
+ */
+int fastBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect) {
+	if (!src || !dst) return SDL_BlitSurface(src, srcrect, dst, dstrect);
+	if (blitKernel(src, dst) == BLIT_KERNEL_SDL) return SDL_BlitSurface(src, srcrect, dst, dstrect);
+	
+	int srcx, srcy, w, h, dx, dy, d;
+	
+	if (srcrect) {
+		srcx = srcrect->x;
+		srcy = srcrect->y;
+		w = srcrect->w;
+		h = srcrect->h;
+	}
+	else {
+		srcx = srcy = 0;
+		w = src->w;
+		h = src->h;
+	}
+	if (dstrect) {
+		dx = dstrect->x;
+		dy = dstrect->y;
+	}
+	else {
+		dx = dy = 0;
+	}
+	
+	// clip to the source surface
+	if (srcx < 0) {
+		w += srcx;
+		dx -= srcx;
+		srcx = 0;
+	}
+	if (w > src->w - srcx) w = src->w - srcx;
+	if (srcy < 0) {
+		h += srcy;
+		dy -= srcy;
+		srcy = 0;
+	}
+	if (h > src->h - srcy) h = src->h - srcy;
+	
+	// clip to the destination clip rect
+	SDL_Rect *clip = &dst->clip_rect;
+	d = clip->x - dx;
+	if (d > 0) {
+		w -= d;
+		srcx += d;
+		dx += d;
+	}
+	d = dx + w - clip->x - clip->w;
+	if (d > 0) w -= d;
+	d = clip->y - dy;
+	if (d > 0) {
+		h -= d;
+		srcy += d;
+		dy += d;
+	}
+	d = dy + h - clip->y - clip->h;
+	if (d > 0) h -= d;
+	
+	SDL_Rect sr;
+	SDL_Rect dr;
+	dr.x = dx;
+	dr.y = dy;
+	if (w > 0 && h > 0) {
+		sr.x = srcx;
+		sr.y = srcy;
+		sr.w = dr.w = w;
+		sr.h = dr.h = h;
+		fastLowerBlit(src, &sr, dst, &dr);
+	}
+	else {
+		dr.w = dr.h = 0;
+	}
+	if (dstrect) *dstrect = dr;
+	return 0;
+}
@@ -0,0 +1,37 @@
+/**
+ * BlitKernels
+ *
+ * Drop-in replacements for SDL_BlitSurface and SDL_LowerBlit with
+ * dedicated loops for the blits the engine does every frame:
+ * - 32-bit ARGB with per-pixel alpha onto 32-bit RGB (everything loaded
+ *   through SDL_DisplayFormatAlpha)
+ * - 32-bit colorkeyed RGB onto 32-bit RGB without alpha
+ * Results match SDL's own blitters for these formats pixel for pixel.
+ * Anything else is handed to SDL.
+ *
+ * flipLowerBlit() draws a source rect mirrored left to right, which SDL
+ * can't do at all. It has its own loop for 8-bit palette sources and
+ * reuses the loops above for 32-bit ones. Callers that draw one palette
+ * source many times can map its palette once with mapPalette().
+ *
+ * @license GPL
+ */
+
+#ifndef BLIT_KERNELS_H
+#define BLIT_KERNELS_H
+
+#include "SDL.h"
+
+const int BLIT_KERNEL_SDL = 0;
+const int BLIT_KERNEL_ALPHA = 1;
+const int BLIT_KERNEL_COLORKEY = 2;
+
+const int BLIT_FLIP_CHUNK = 256; // pixels of a source row mirrored at a time
+
+int blitKernel(SDL_Surface *src, SDL_Surface *dst);
+int fastBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect);
+int fastLowerBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect);
+void mapPalette(SDL_Surface *src, SDL_Surface *dst, Uint32 *map);
+int flipLowerBlit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, const Uint32 *palette_map = NULL);
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * class BlitQueue
+ *
+ * Records blits to one target surface and replays them in a single flush.
+ * Blits that land entirely off the target are dropped when recorded.
+ *
+ * With worker threads the target is cut into horizontal bands, and each band
+ * replays every command that touches it, in order, clipped to the band.
+ * Bands share no pixels, so the result matches blitting serially.
+ * Mirrored blits are clipped and replayed the same way; an 8-bit palette
+ * source drawn mirrored has its palette mapped once per flush.
+ *
+ * @license GPL
+ */
+
+#include "BlitQueue.h"
+
+BlitQueue::BlitQueue(SDL_Surface *_target, TaskScheduler *_tasks) {
+	target = _target;
+	tasks = _tasks;
+	count = 0;
+}
+
+/**
+ * Same arguments as SDL_BlitSurface; dest w and h are ignored.
+ * With flip, src_rect is drawn mirrored left to right.
+ */
+void BlitQueue::blit(SDL_Surface *src, SDL_Rect *src_rect, SDL_Rect *dest, bool flip) {
+	if (!src) return;
+	
+	SDL_Rect *clip = &target->clip_rect;
+	if (dest->x >= clip->x + clip->w || dest->y >= clip->y + clip->h ||
+	    dest->x + src_rect->w <= clip->x || dest->y + src_rect->h <= clip->y)
+		return;
+	
+	if (count == BLIT_QUEUE_SIZE) flush();
+	
+	BlitCommand *c = &commands[count++];
+	c->src = src;
+	c->src_rect = *src_rect;
+	c->x = dest->x;
+	c->y = dest->y;
+	c->flip = flip;
+	c->palette = -1;
+}
+
+/**
+ * Map the palette of every 8-bit source drawn mirrored, once, and point
+ * its commands at the table. The straight blits go through SDL, which
+ * keeps its own mapping.
+ */
+void BlitQueue::mapPalettes() {
+	int palette_count = 0;
+	
+	for (int i=0; i<count; i++) {
+		BlitCommand *c = &commands[i];
+		if (!c->flip || c->src->format->BytesPerPixel != 1 || !c->src->format->palette) continue;
+		
+		if (i > 0 && commands[i-1].src == c->src && commands[i-1].palette != -1) {
+			c->palette = commands[i-1].palette;
+			continue;
+		}
+		for (int j=0; j<palette_count && c->palette == -1; j++) {
+			if (palette_sources[j] == c->src) c->palette = j;
+		}
+		if (c->palette == -1 && palette_count < BLIT_PALETTE_MAPS) {
+			palette_sources[palette_count] = c->src;
+			mapPalette(c->src, target, palette_maps[palette_count]);
+			c->palette = palette_count++;
+		}
+	}
+}
+
+void BlitQueue::replayBands(void *data, int begin, int end) {
+	BlitQueue *q = (BlitQueue *)data;
+	for (int i=begin; i<end; i++) {
+		q->replay(q->bands[i]);
+	}
+}
+
+/**
+ * Blit every command clipped to band, the way SDL_UpperBlit clips to the
+ * target's clip rect. The target clip is left alone so bands can run at once.
+ */
+void BlitQueue::replay(const SDL_Rect &band) {
+	SDL_Rect sr;
+	SDL_Rect dr;
+	int srcx, srcy, dx, dy, w, h, d;
+	
+	for (int i=0; i<count; i++) {
+		BlitCommand *c = &commands[i];
+		
+		// clip to the source surface; a mirrored blit draws the source's
+		// left edge on the right, so that is the side of dest it loses
+		srcx = c->src_rect.x;
+		srcy = c->src_rect.y;
+		w = c->src_rect.w;
+		h = c->src_rect.h;
+		dx = c->x;
+		dy = c->y;
+		if (srcx < 0) {
+			w += srcx;
+			if (!c->flip) dx -= srcx;
+			srcx = 0;
+		}
+		if (w > c->src->w - srcx) {
+			if (c->flip) dx += w - (c->src->w - srcx);
+			w = c->src->w - srcx;
+		}
+		if (srcy < 0) {
+			h += srcy;
+			dy -= srcy;
+			srcy = 0;
+		}
+		if (h > c->src->h - srcy) h = c->src->h - srcy;
+		
+		// clip to the band
+		d = band.x - dx;
+		if (d > 0) {
+			w -= d;
+			if (!c->flip) srcx += d;
+			dx += d;
+		}
+		d = dx + w - band.x - band.w;
+		if (d > 0) {
+			w -= d;
+			if (c->flip) srcx += d;
+		}
+		d = band.y - dy;
+		if (d > 0) {
+			h -= d;
+			srcy += d;
+			dy += d;
+		}
+		d = dy + h - band.y - band.h;
+		if (d > 0) h -= d;
+		
+		if (w <= 0 || h <= 0) continue;
+		
+		sr.x = srcx;
+		sr.y = srcy;
+		sr.w = dr.w = w;
+		sr.h = dr.h = h;
+		dr.x = dx;
+		dr.y = dy;
+		if (c->flip) flipLowerBlit(c->src, &sr, target, &dr, c->palette == -1 ? NULL : palette_maps[c->palette]);
+		else fastLowerBlit(c->src, &sr, target, &dr);
+	}
+}
+
+/**
+ * Draw everything recorded so far, in order, and empty the queue
+ */
+void BlitQueue::flush() {
+	if (count == 0) return;
+	
+	mapPalettes();
+	
+	int band_count = (tasks->workers() + 1) * BLIT_BANDS_PER_THREAD;
+	if (band_count > BLIT_MAX_BANDS) band_count = BLIT_MAX_BANDS;
+	
+	// a target that needs locking can't be shared between threads
+	if (tasks->workers() == 0 || SDL_MUSTLOCK(target)) {
+		replay(target->clip_rect);
+		count = 0;
+		return;
+	}
+	
+	// SDL builds a source's blit mapping on its first blit to a target.
+	// Build them here with empty blits so the bands only read them,
+	// once per distinct source; map layers interleave a few tilesets.
+	SDL_Rect empty_src;
+	SDL_Rect empty_dest;
+	int mapped_count = 0;
+	for (int i=0; i<count; i++) {
+		if (i > 0 && commands[i].src == commands[i-1].src) continue;
+		
+		bool seen = false;
+		for (int j=0; j<mapped_count && !seen; j++) {
+			seen = (mapped[j] == commands[i].src);
+		}
+		if (seen) continue;
+		mapped[mapped_count++] = commands[i].src;
+		
+		empty_src.x = empty_src.y = 0;
+		empty_src.w = empty_src.h = 0;
+		empty_dest = empty_src;
+		SDL_LowerBlit(commands[i].src, &empty_src, target, &empty_dest);
+	}
+	
+	SDL_Rect clip = target->clip_rect;
+	int band_h = (clip.h + band_count - 1) / band_count;
+	int bands_used = 0;
+	for (int y = clip.y; y < clip.y + clip.h; y += band_h) {
+		bands[bands_used].x = clip.x;
+		bands[bands_used].y = y;
+		bands[bands_used].w = clip.w;
+		bands[bands_used].h = band_h;
+		if (y + band_h > clip.y + clip.h) bands[bands_used].h = clip.y + clip.h - y;
+		bands_used++;
+	}
+	
+	TaskGroup group;
+	tasks->parallelFor(replayBands, this, bands_used, 1, &group);
+	tasks->wait(&group);
+	
+	count = 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * class BlitQueue
+ *
+ * Records blits to one target surface and replays them in a single flush.
+ * Blits that land entirely off the target are dropped when recorded.
+ *
+ * With worker threads the target is cut into horizontal bands, and each band
+ * replays every command that touches it, in order, clipped to the band.
+ * Bands share no pixels, so the result matches blitting serially.
+ * Mirrored blits are clipped and replayed the same way; an 8-bit palette
+ * source drawn mirrored has its palette mapped once per flush.
+ *
+ * @license GPL
+ */
+
+#ifndef BLIT_QUEUE_H
+#define BLIT_QUEUE_H
+
+#include "SDL.h"
+#include "TaskScheduler.h"
+#include "BlitKernels.h"
+
+const int BLIT_QUEUE_SIZE = 8192; // commands held before an early flush
+const int BLIT_MAX_BANDS = 32;
+const int BLIT_BANDS_PER_THREAD = 2; // spare bands even out busy and empty parts of the screen
+const int BLIT_PALETTE_MAPS = 32; // palette sources mapped per flush; more map on every blit
+
+struct BlitCommand {
+	SDL_Surface *src;
+	SDL_Rect src_rect;
+	Sint16 x;
+	Sint16 y;
+	bool flip;
+	int palette; // index into palette_maps, or -1
+};
+
+class BlitQueue {
+private:
+	SDL_Surface *target;
+	TaskScheduler *tasks;
+	
+	BlitCommand commands[BLIT_QUEUE_SIZE];
+	int count;
+	
+	SDL_Surface *mapped[BLIT_QUEUE_SIZE]; // distinct sources of this flush
+	
+	SDL_Surface *palette_sources[BLIT_PALETTE_MAPS];
+	Uint32 palette_maps[BLIT_PALETTE_MAPS][256];
+	
+	SDL_Rect bands[BLIT_MAX_BANDS];
+	
+	void mapPalettes();
+	static void replayBands(void *data, int begin, int end);
+	void replay(const SDL_Rect &band);
+
+public:
+	BlitQueue(SDL_Surface *_target, TaskScheduler *_tasks);
+	
+	void blit(SDL_Surface *src, SDL_Rect *src_rect, SDL_Rect *dest, bool flip);
+	void flush();
+};
+
+#endif
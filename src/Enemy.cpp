@@ -22,8 +22,6 @@ Enemy::Enemy(PowerManager *_powers, MapIso *_map) {
 	stats.last_seen.y = -1;
 	stats.in_combat = false;
 	
-	haz = NULL;
-	
 	sfx_phys = false;
 	sfx_ment = false;
 	sfx_hit = false;
@@ -31,6 +29,13 @@ Enemy::Enemy(PowerManager *_powers, MapIso *_map) {
 	sfx_critdie = false;
 	loot_drop = false;
 	reward_xp = false;
+	
+	sprite_index = -1;
+	sound_index = -1;
+	
+	seen_hero = false;
+	steering = false;
+	perceive = true;
 }
 
 /**
@@ -215,10 +220,14 @@ void Enemy::logic() {
 		stats.last_seen.y = -1;
 	}
 
-	if (dist < stats.threat_range && stats.hero_alive)
-		los = map->collider.line_of_sight(stats.pos.x, stats.pos.y, stats.hero_pos.x, stats.hero_pos.y);
-	else
-		los = false;
+	if (dist < stats.threat_range && stats.hero_alive) {
+		// perception is spread across frames; between refreshes keep the last answer
+		if (perceive) seen_hero = map->collider.is_visible(stats.pos.x, stats.pos.y); // visibility field is centered on the hero
+		los = seen_hero;
+	}
+	else {
+		los = seen_hero = false;
+	}
 		
 	// if the enemy can see the hero, it pursues.
 	// otherwise, it will head towards where it last saw the hero
@@ -260,6 +269,23 @@ void Enemy::logic() {
 		pursue_pos.x = stats.last_seen.x;
 		pursue_pos.y = stats.last_seen.y;
 	}
+	
+	// steer along a path when walls block the straight line.
+	// Chasing the hero reads the shared flow field; other targets use a path search.
+	Point steer_pos = pursue_pos;
+	if (!stats.in_combat) {
+		steering = false;
+	}
+	else if (perceive) {
+		steering = false;
+		if (!map->collider.line_of_movement(stats.pos.x, stats.pos.y, pursue_pos.x, pursue_pos.y)) {
+			if (map->pathfinder.flowStep(stats.pos, pursue_pos, steer_waypoint))
+				steering = true;
+			else if (map->pathfinder.findPath(stats.pos, pursue_pos, steer_waypoint) == PATH_FOUND)
+				steering = true;
+		}
+	}
+	if (steering) steer_pos = steer_waypoint;
 
 
 	
@@ -286,7 +312,7 @@ void Enemy::logic() {
 
 				// update direction to face the target
 				if (++stats.dir_ticks > stats.dir_favor && stats.patrol_ticks == 0) {
-					stats.direction = face(pursue_pos.x, pursue_pos.y);				
+					stats.direction = face(steer_pos.x, steer_pos.y);				
 					stats.dir_ticks = 0;
 				}
 		
@@ -322,7 +348,7 @@ void Enemy::logic() {
 						else {
 							// hit an obstacle, try the next best angle
 							prev_direction = stats.direction;
-							stats.direction = faceNextBest(pursue_pos.x, pursue_pos.y);
+							stats.direction = faceNextBest(steer_pos.x, steer_pos.y);
 							if (move()) {
 								newState(ENEMY_MOVE);
 								break;
@@ -371,7 +397,7 @@ void Enemy::logic() {
 			if (stats.in_combat) {
 
 				if (++stats.dir_ticks > stats.dir_favor && stats.patrol_ticks == 0) {
-					stats.direction = face(pursue_pos.x, pursue_pos.y);				
+					stats.direction = face(steer_pos.x, steer_pos.y);				
 					stats.dir_ticks = 0;
 				}
 				
@@ -399,7 +425,7 @@ void Enemy::logic() {
 					if (!move()) {
 						// hit an obstacle.  Try the next best angle
 						prev_direction = stats.direction;
-						stats.direction = faceNextBest(pursue_pos.x, pursue_pos.y);
+						stats.direction = faceNextBest(steer_pos.x, steer_pos.y);
 						if (!move()) {
 							newState(ENEMY_STANCE);
 							stats.direction = prev_direction;
@@ -429,7 +455,7 @@ void Enemy::logic() {
 			}
 
 			// the attack hazard is alive for a single frame
-			if (stats.cur_frame == max_frame/2 && haz == NULL) {
+			if (stats.cur_frame == max_frame/2) {
 				powers->activate(stats.power_index[MELEE_PHYS], &stats, pursue_pos);
 				stats.power_ticks[MELEE_PHYS] = stats.power_cooldown[MELEE_PHYS];
 			}
@@ -455,7 +481,7 @@ void Enemy::logic() {
 			}
 			
 			// the attack hazard is alive for a single frame
-			if (stats.cur_frame == max_frame/2 && haz == NULL) {
+			if (stats.cur_frame == max_frame/2) {
 				powers->activate(stats.power_index[RANGED_PHYS], &stats, pursue_pos);
 				stats.power_ticks[RANGED_PHYS] = stats.power_cooldown[RANGED_PHYS];
 			}
@@ -479,7 +505,7 @@ void Enemy::logic() {
 			}
 			
 			// the attack hazard is alive for a single frame
-			if (stats.cur_frame == max_frame/2 && haz == NULL) {
+			if (stats.cur_frame == max_frame/2) {
 				powers->activate(stats.power_index[MELEE_MENT], &stats, pursue_pos);
 				stats.power_ticks[MELEE_MENT] = stats.power_cooldown[MELEE_MENT];
 			}
@@ -505,7 +531,7 @@ void Enemy::logic() {
 			}
 			
 			// the attack hazard is alive for a single frame
-			if (stats.cur_frame == max_frame/2 && haz == NULL) {
+			if (stats.cur_frame == max_frame/2) {
 				powers->activate(stats.power_index[RANGED_MENT], &stats, pursue_pos);
 				stats.power_ticks[RANGED_MENT] = stats.power_cooldown[RANGED_MENT];
 			}
@@ -573,7 +599,7 @@ void Enemy::logic() {
  *
  * Returns false on miss
  */
-bool Enemy::takeHit(Hazard h) {
+bool Enemy::takeHit(const Hazard &h) {
 	if (stats.cur_state != ENEMY_DEAD && stats.cur_state != ENEMY_CRITDEAD) {
 	
 		if (!stats.in_combat) {
@@ -622,7 +648,7 @@ bool Enemy::takeHit(Hazard h) {
 		bool crit = (rand() % 100) < true_crit_chance;
 		if (crit) {
 			dmg = dmg + h.dmg_max;
-			map->shaky_cam_ticks = FRAMES_PER_SEC/2;
+			map->shaky_cam_pending = FRAMES_PER_SEC/2;
 		}
 		
 		// apply damage
@@ -731,11 +757,11 @@ Renderable Enemy::getRender() {
 	
 	// draw corpses below objects so that floor loot is more visible
 	r.object_layer = !stats.corpse;
+	r.flip = false;
 	
 	return r;	
 }
 
 Enemy::~Enemy() {
-	delete haz;
 }
 
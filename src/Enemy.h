@@ -39,11 +39,21 @@ const int ENEMY_HIT = 8;
 const int ENEMY_DEAD = 9;
 const int ENEMY_CRITDEAD = 10;
 
+// AI level-of-detail tiers (see EnemyManager::logic)
+const int AI_TIER_ACTIVE = 0; // near the hero or busy: every frame
+const int AI_TIER_NEAR = 1; // reduced rate
+const int AI_TIER_DORMANT = 2; // far away: rarely
+
 class Enemy {
 private:
 	MapIso *map;
 	PowerManager *powers;
 	
+	// last perception results, reused on frames without a perception slot
+	bool seen_hero;
+	bool steering;
+	Point steer_waypoint;
+	
 public:
 	Enemy(PowerManager *_powers, MapIso *_map);
 	~Enemy();
@@ -54,12 +64,11 @@ public:
 	int faceNextBest(int mapx, int mapy);
 	void newState(int state);
 	int getDistance(Point dest);
-	bool takeHit(Hazard h);
+	bool takeHit(const Hazard &h);
 	void doRewards();
 	
 	Renderable getRender();
 
-	Hazard *haz;
 	StatBlock stats;
 
 
@@ -74,6 +83,13 @@ public:
 	// other flags
 	bool loot_drop;
 	bool reward_xp;
+	
+	// shared resources, resolved by EnemyManager (-1 if none)
+	int sprite_index;
+	int sound_index;
+	
+	// set by EnemyManager's AI scheduler
+	bool perceive; // refresh line of sight and steering this frame
 };
 
 
@@ -14,8 +14,13 @@ EnemyManager::EnemyManager(PowerManager *_powers, MapIso *_map) {
 	enemy_count = 0;
 	sfx_count = 0;
 	gfx_count = 0;
+	archetype_count = 0;
 	hero_pos.x = hero_pos.y = -1;
 	hero_alive = true;
+	ai_frame = 0;
+	perception_cursor = 0;
+	perceptions = 0;
+	for (int i=0; i<3; i++) tier_count[i] = 0;
 	handleNewMap();
 }
 
@@ -23,48 +28,62 @@ EnemyManager::EnemyManager(PowerManager *_powers, MapIso *_map) {
 
 /**
  * Enemies share graphic/sound resources (usually there are groups of similar enemies)
+ * Returns the sprite index for this prefix, or -1 if there is no room
  */
-void EnemyManager::loadGraphics(string type_id) {
-	
-	// TODO: throw an error if a map tries to use too many monsters
-	if (gfx_count == max_gfx) return;
+int EnemyManager::loadGraphics(string type_id, string base_id, Point frame_size, int *mirror) {
 	
 	// first check to make sure the sprite isn't already loaded
 	for (int i=0; i<gfx_count; i++) {
 		if (gfx_prefixes[i] == type_id) {
-			return; // already have this one
+			return i; // already have this one
 		}
 	}
+	
+	// a recolor shares the pixels of its base sheet
+	int base = -1;
+	if (base_id != "" && base_id != type_id) base = loadGraphics(base_id, "", frame_size, mirror);
+	
+	// TODO: throw an error if a map tries to use too many monsters
+	if (gfx_count == max_gfx) return -1;
 
-	sprites[gfx_count] = IMG_Load(("images/enemies/" + type_id + ".png").c_str());
-	if(!sprites[gfx_count]) {
+	SDL_Surface *sheet = IMG_Load(("images/enemies/" + type_id + ".png").c_str());
+	if(!sheet) {
 		fprintf(stderr, "Couldn't load image: %s\n", IMG_GetError());
 		SDL_Quit();
 	}
-	SDL_SetColorKey( sprites[gfx_count], SDL_SRCCOLORKEY, SDL_MapRGB(sprites[gfx_count]->format, 255, 0, 255) ); 
-
-	// optimize
-	SDL_Surface *cleanup = sprites[gfx_count];
-	sprites[gfx_count] = SDL_DisplayFormatAlpha(sprites[gfx_count]);
-	SDL_FreeSurface(cleanup);	
+	SDL_SetColorKey( sheet, SDL_SRCCOLORKEY, SDL_MapRGB(sheet->format, 255, 0, 255) ); 
+	
+	// trim the animation frames and pack them as 8-bit palette pixels,
+	// leaving out direction rows drawn as mirrors of other rows
+	sprites[gfx_count] = new SpriteAtlas();
+	for (int i=0; i<8; i++) {
+		if (mirror[i] != -1) sprites[gfx_count]->mirror(i, mirror[i]);
+	}
+	if (base != -1)
+		sprites[gfx_count]->recolor(sprites[base], sheet, "images/enemies/" + type_id + ".png");
+	else
+		sprites[gfx_count]->packIndexed(sheet, frame_size.x, frame_size.y, "images/enemies/" + type_id + ".png");
 	
 	gfx_prefixes[gfx_count] = type_id;
-	gfx_count++;
+	return gfx_count++;
 
 }
 
-void EnemyManager::loadSounds(string type_id) {
+/**
+ * Returns the sound index for this prefix, or -1 if there is no room
+ */
+int EnemyManager::loadSounds(string type_id) {
 
-	// TODO: throw an error if a map tries to use too many monsters
-	if (sfx_count == max_sfx) return;
-	
-	// first check to make sure the sprite isn't already loaded
+	// first check to make sure the sounds aren't already loaded
 	for (int i=0; i<sfx_count; i++) {
 		if (sfx_prefixes[i] == type_id) {
-			return; // already have this one
+			return i; // already have this one
 		}
 	}
 	
+	// TODO: throw an error if a map tries to use too many monsters
+	if (sfx_count == max_sfx) return -1;
+	
 	sound_phys[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_phys.ogg").c_str());
 	sound_ment[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_ment.ogg").c_str());
 	sound_hit[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_hit.ogg").c_str());
@@ -72,7 +91,39 @@ void EnemyManager::loadSounds(string type_id) {
 	sound_critdie[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_critdie.ogg").c_str());
 	
 	sfx_prefixes[sfx_count] = type_id;
-	sfx_count++;
+	return sfx_count++;
+}
+
+/**
+ * The parsed template for an enemy type, loading its file the first time it is seen.
+ * Returns NULL if the cache is full and the type is new.
+ */
+StatBlock *EnemyManager::loadArchetype(string type) {
+	for (int i=0; i<archetype_count; i++) {
+		if (archetype_types[i] == type) return archetypes[i];
+	}
+	
+	if (archetype_count == max_archetypes) {
+		fprintf(stderr, "Too many enemy types, can't load %s\n", type.c_str());
+		return NULL;
+	}
+	
+	// start from the same state a fresh Enemy gives its stats
+	StatBlock *stats = new StatBlock();
+	stats->cur_state = ENEMY_STANCE;
+	stats->cur_frame = 0;
+	stats->disp_frame = 0;
+	stats->dir_ticks = FRAMES_PER_SEC;
+	stats->patrol_ticks = 0;
+	stats->cooldown = 0;
+	stats->last_seen.x = -1;
+	stats->last_seen.y = -1;
+	stats->in_combat = false;
+	stats->load("enemies/" + type + ".txt");
+	
+	archetypes[archetype_count] = stats;
+	archetype_types[archetype_count] = type;
+	return archetypes[archetype_count++];
 }
 
 /**
@@ -91,7 +142,7 @@ void EnemyManager::handleNewMap () {
 	
 	// free shared resources
 	for (int j=0; j<gfx_count; j++) {
-		SDL_FreeSurface(sprites[j]);
+		delete sprites[j];
 	}
 	for (int j=0; j<sfx_count; j++) {
 		Mix_FreeChunk(sound_phys[j]);
@@ -108,39 +159,96 @@ void EnemyManager::handleNewMap () {
 		me = map->enemies.front();
 		map->enemies.pop();
 		
+		StatBlock *archetype = loadArchetype(me.type);
+		if (archetype == NULL) continue;
+		
 		enemies[enemy_count] = new Enemy(powers, map);
+		enemies[enemy_count]->stats = *archetype;
 		enemies[enemy_count]->stats.pos.x = me.pos.x;
 		enemies[enemy_count]->stats.pos.y = me.pos.y;
 		enemies[enemy_count]->stats.direction = me.direction;
-		enemies[enemy_count]->stats.load("enemies/" + me.type + ".txt");
-		loadGraphics(enemies[enemy_count]->stats.gfx_prefix);
-		loadSounds(enemies[enemy_count]->stats.sfx_prefix);
+		enemies[enemy_count]->sprite_index = loadGraphics(archetype->gfx_prefix, archetype->gfx_base, archetype->render_size, archetype->render_mirror);
+		enemies[enemy_count]->sound_index = loadSounds(archetype->sfx_prefix);
+		hot_tier[enemy_count] = AI_TIER_ACTIVE;
+		hot_skipped[enemy_count] = 0;
 		enemy_count++;
 	}
+	pack();
+}
+
+/**
+ * Pick an enemy's AI tier from its distance to the hero.
+ * Anything busy (fighting, animating an action or a death) stays active.
+ */
+int EnemyManager::classify(int i) {
+	if (hot_cooldown[i] > 0) return AI_TIER_ACTIVE;
+
+	// hazards may have hit since pack(), so state comes from the stats
+	StatBlock *s = &enemies[i]->stats;
+	if (s->in_combat) return AI_TIER_ACTIVE;
+	if (s->cur_state == ENEMY_DEAD || s->cur_state == ENEMY_CRITDEAD) {
+		if (s->corpse) return AI_TIER_DORMANT;
+		return AI_TIER_ACTIVE;
+	}
+	if (s->cur_state != ENEMY_STANCE) return AI_TIER_ACTIVE;
+
+	int dx = hot_pos[i].x - hero_pos.x;
+	int dy = hot_pos[i].y - hero_pos.y;
+	int dist_sq = dx*dx + dy*dy;
+
+	// awake enough to notice the hero walking into threat range
+	int threat = hot_chase[i] >> 1;
+	int wake = threat + AI_WAKE_MARGIN;
+	if (dist_sq < wake * wake) return AI_TIER_ACTIVE;
+
+	// within reach of a few seconds' walk
+	int near = threat * 4;
+	if (dist_sq < near * near) return AI_TIER_NEAR;
+
+	return AI_TIER_DORMANT;
 }
 
 /**
  * perform logic() for all enemies
+ *
+ * Enemies far from the hero update at a reduced rate and catch up on their
+ * status timers when they do. Line of sight and steering for active enemies
+ * are refreshed round-robin, at most AI_PERCEPTION_BUDGET per frame.
  */
 void EnemyManager::logic() {
-	int pref_id;
+
+	ai_frame++;
+	for (int i=0; i<3; i++) tier_count[i] = 0;
+	for (int i=0; i<enemy_count; i++) {
+		hot_tier[i] = classify(i);
+		enemies[i]->perceive = (hot_tier[i] != AI_TIER_ACTIVE);
+		tier_count[hot_tier[i]]++;
+	}
+	
+	// hand out perception slots, continuing where last frame stopped
+	perceptions = 0;
+	for (int j=0; j<enemy_count && perceptions < AI_PERCEPTION_BUDGET; j++) {
+		int i = (perception_cursor + j) % enemy_count;
+		if (hot_tier[i] != AI_TIER_ACTIVE) continue;
+		enemies[i]->perceive = true;
+		perceptions++;
+		if (perceptions == AI_PERCEPTION_BUDGET) perception_cursor = (i + 1) % enemy_count;
+	}
 
 	for (int i=0; i<enemy_count; i++) {
 	
 		// hazards are processed after Avatar and Enemy[]
 		// so process and clear sound effects from previous frames
 		// check sound effects
-		for (int j=0; j<sfx_count; j++) {
-			if (sfx_prefixes[j] == enemies[i]->stats.sfx_prefix)
-				pref_id = j;
+		int pref_id = enemies[i]->sound_index;
+		if (pref_id != -1) {
+			if (enemies[i]->sfx_phys) sound_queue.play(sound_phys[pref_id]);
+			if (enemies[i]->sfx_ment) sound_queue.play(sound_ment[pref_id]);
+			if (enemies[i]->sfx_hit) sound_queue.play(sound_hit[pref_id]);
+			if (enemies[i]->sfx_die) sound_queue.play(sound_die[pref_id]);		
+			if (enemies[i]->sfx_critdie) sound_queue.play(sound_critdie[pref_id]);		
 		}
 		
-		if (enemies[i]->sfx_phys) Mix_PlayChannel(-1, sound_phys[pref_id], 0);
-		if (enemies[i]->sfx_ment) Mix_PlayChannel(-1, sound_ment[pref_id], 0);
-		if (enemies[i]->sfx_hit) Mix_PlayChannel(-1, sound_hit[pref_id], 0);
-		if (enemies[i]->sfx_die) Mix_PlayChannel(-1, sound_die[pref_id], 0);		
-		if (enemies[i]->sfx_critdie) Mix_PlayChannel(-1, sound_critdie[pref_id], 0);		
-		
 		// clear sound flags
 		enemies[i]->sfx_hit = false;
 		enemies[i]->sfx_phys = false;
@@ -151,9 +259,53 @@ void EnemyManager::logic() {
 		// new actions this round
 		enemies[i]->stats.hero_pos = hero_pos;
 		enemies[i]->stats.hero_alive = hero_alive;
+		
+		// staggered so the slower tiers don't all land on the same frame
+		int interval = 1;
+		if (hot_tier[i] == AI_TIER_NEAR) interval = AI_NEAR_INTERVAL;
+		else if (hot_tier[i] == AI_TIER_DORMANT) interval = AI_DORMANT_INTERVAL;
+		if ((ai_frame + i) % interval != 0) {
+			hot_skipped[i]++;
+			continue;
+		}
+		
+		enemies[i]->stats.advance(hot_skipped[i]);
+		hot_skipped[i] = 0;
 		enemies[i]->logic();
 
 	}
+	
+	pack();
+}
+
+/**
+ * Copy the fields the all-enemy scans need into the packed hot arrays
+ */
+void EnemyManager::pack() {
+	for (int i=0; i<enemy_count; i++) {
+		StatBlock *s = &enemies[i]->stats;
+		hot_pos[i] = s->pos;
+		hot_hp[i] = s->hp;
+		hot_cooldown[i] = s->cooldown_ticks;
+		if (s->cur_state == ENEMY_DEAD || s->cur_state == ENEMY_CRITDEAD)
+			hot_chase[i] = 0;
+		else
+			hot_chase[i] = s->threat_range + s->threat_range;
+	}
+}
+
+/**
+ * How far from the hero any living enemy could still be chasing.
+ * Enemies give up at twice their threat range; 0 means nobody is near.
+ */
+int EnemyManager::chaseReach() {
+	int reach = 0;
+	for (int i=0; i<enemy_count; i++) {
+		int chase = hot_chase[i];
+		if (chase > reach && calcDist(hot_pos[i], hero_pos) <= chase)
+			reach = chase;
+	}
+	return reach;
 }
 
 Enemy* EnemyManager::enemyFocus(Point mouse, Point cam, bool alive_only) {
@@ -199,10 +351,8 @@ void EnemyManager::checkEnemiesforXP(StatBlock *stats) {
  */
 Renderable EnemyManager::getRender(int enemyIndex) {
 	Renderable r = enemies[enemyIndex]->getRender();
-	for (int i=0; i<gfx_count; i++) {
-		if (gfx_prefixes[i] == enemies[enemyIndex]->stats.gfx_prefix)
-			r.sprite = sprites[i];
-	}
+	if (enemies[enemyIndex]->sprite_index != -1)
+		sprites[enemies[enemyIndex]->sprite_index]->lookup(r);
 	return r;	
 }
 
@@ -210,9 +360,12 @@ EnemyManager::~EnemyManager() {
 	for (int i=0; i<enemy_count; i++) {
 		delete enemies[i];
 	}
+	for (int i=0; i<archetype_count; i++) {
+		delete archetypes[i];
+	}
 	
 	for (int i=0; i<gfx_count; i++) {
-		SDL_FreeSurface(sprites[i]);
+		delete sprites[i];
 	}
 	for (int i=0; i<sfx_count; i++) {
 		Mix_FreeChunk(sound_phys[i]);
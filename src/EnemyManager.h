@@ -12,32 +12,52 @@
 #include "MapIso.h"
 #include "Enemy.h"
 #include "Utils.h"
+#include "SpriteAtlas.h"
 #include "PowerManager.h"
+#include "SoundQueue.h"
 
 // TODO: rename these to something more specific to EnemyManager
 const int max_sfx = 8;
 const int max_gfx = 32;
+const int max_archetypes = 64;
+
+// AI scheduler
+const int AI_NEAR_INTERVAL = 4; // frames between updates for AI_TIER_NEAR
+const int AI_DORMANT_INTERVAL = 32; // frames between updates for AI_TIER_DORMANT
+const int AI_WAKE_MARGIN = 128; // enemies this far beyond threat_range stay active
+const int AI_PERCEPTION_BUDGET = 16; // line of sight/steering refreshes per frame
 
 class EnemyManager {
 private:
 
 	MapIso *map;
 	PowerManager *powers;
-	void loadGraphics(string type_id);
-	void loadSounds(string type_id);
+	int loadGraphics(string type_id, string base_id, Point frame_size, int *mirror);
+	int loadSounds(string type_id);
+	StatBlock *loadArchetype(string type);
+	
+	// enemy files parsed once per session, keyed by map enemy type
+	string archetype_types[max_archetypes];
+	StatBlock *archetypes[max_archetypes];
+	int archetype_count;
 
 	string gfx_prefixes[max_gfx];
 	int gfx_count;
 	string sfx_prefixes[max_sfx];
 	int sfx_count;
 	
-	SDL_Surface *sprites[max_gfx];	
+	SpriteAtlas *sprites[max_gfx];
 	Mix_Chunk *sound_phys[max_sfx];
 	Mix_Chunk *sound_ment[max_sfx];
 	Mix_Chunk *sound_hit[max_sfx];
 	Mix_Chunk *sound_die[max_sfx];
 	Mix_Chunk *sound_critdie[max_sfx];
 	
+	int ai_frame;
+	int perception_cursor;
+	int classify(int i);
+	void pack();
+	
 public:
 	EnemyManager(PowerManager *_powers, MapIso *_map);
 	~EnemyManager();
@@ -46,12 +66,28 @@ public:
 	Renderable getRender(int enemyIndex);
 	void checkEnemiesforXP(StatBlock *stats);
 	Enemy *enemyFocus(Point mouse, Point cam, bool alive_only);
+	int chaseReach();
 
 	// vars
 	Enemy *enemies[256]; // TODO: change to dynamic list without limits
 	Point hero_pos;
 	bool hero_alive;
 	int enemy_count;
+	
+	// Per-frame fields of every enemy, packed side by side so the loops that
+	// scan all of them stream through arrays instead of each StatBlock.
+	// Refreshed by pack() at the end of logic(). Positions and cooldowns hold
+	// for the rest of the frame; hp can only have dropped since.
+	Point hot_pos[256];
+	int hot_hp[256];
+	int hot_chase[256]; // twice the threat range, or 0 if dead
+	int hot_cooldown[256];
+	int hot_tier[256]; // AI_TIER_*
+	int hot_skipped[256]; // frames since the enemy's last logic()
+	
+	// AI scheduler statistics for the last frame
+	int tier_count[3];
+	int perceptions;
 };
 
 
@@ -15,6 +15,14 @@ FontEngine::FontEngine() {
 	for (int i=0; i<256; i++) {
 		width[i] = 0;
 	}
+	for (int i=0; i<FONT_CACHE_SIZE; i++) {
+		cache[i].surface = NULL;
+	}
+	cache_count = 0;
+	layout_count = 0;
+	cache_tick = 0;
+	cache_hits = 0;
+	cache_misses = 0;
 	load();
 }
 
@@ -69,9 +77,21 @@ void FontEngine::load() {
 	sprites[FONT_BLUE] = IMG_Load("fonts/blue.png");
 	sprites[FONT_GRAY] = IMG_Load("fonts/gray.png");
 	
+	// optimize; run compositing relies on the 32-bit display format
+	SDL_Surface *cleanup;
+	for (int i=0; i<5; i++) {
+		if (!sprites[i]) {
+			fprintf(stderr, "Couldn't load font image: %s\n", IMG_GetError());
+			continue;
+		}
+		cleanup = sprites[i];
+		sprites[i] = SDL_DisplayFormatAlpha(sprites[i]);
+		SDL_FreeSurface(cleanup);
+	}
+	
 }
 
-int FontEngine::calc_length(string text) {
+int FontEngine::calc_length(const string &text) {
 	int size=0;
 	char c;
 	for (unsigned int i=0; i<text.length(); i++) {
@@ -86,148 +106,378 @@ int FontEngine::calc_length(string text) {
  * Using the given wrap width, calculate the width and height necessary to display this text
  */
 Point FontEngine::calc_size(string text_with_newlines, int width) {
-	char newline = 10;
-	
-	string text = text_with_newlines;
+	return layout(text_with_newlines, width)->size;
+}
 
-	// if this contains newlines, recurse
-	int check_newline = text.find_first_of(newline);
-	if (check_newline > -1) {
-		Point p1 = calc_size(text.substr(0, check_newline), width);
-		Point p2 = calc_size(text.substr(check_newline+1, text.length()), width);
-		Point p3;
-		
-		if (p1.x > p2.x) p3.x = p1.x;
-		else p3.x = p2.x;
-		
-		p3.y = p1.y + p2.y;
-		return p3;
+/**
+ * Break text into lines no wider than width, in a single pass.
+ * Words are split on spaces and newlines force a break. A word too long
+ * for the width gets a line of its own. Results are cached per (text, width);
+ * the returned layout is valid until the next call.
+ */
+TextLayout *FontEngine::layout(const string &text, int width) {
+	unsigned int hash = hashText(text.c_str());
+	TextLayout *lay;
+	
+	for (int i=0; i<layout_count; i++) {
+		if (layouts[i].hash == hash && layouts[i].width == width && layouts[i].text == text) {
+			layouts[i].last_used = ++cache_tick;
+			return &layouts[i];
+		}
 	}
-
-	int height = 0;
-	int max_width = 0;
-
-	string segment;
-	string fulltext;
-	string builder = "";
-	string builder_prev = "";
-	char space = 32;
 	
-	fulltext = text + " ";
-	segment = eatFirstString(fulltext, space);
+	// not cached; take a free slot or evict the least recently used
+	if (layout_count < FONT_LAYOUT_CACHE_SIZE) {
+		lay = &layouts[layout_count++];
+	}
+	else {
+		lay = &layouts[0];
+		for (int i=1; i<FONT_LAYOUT_CACHE_SIZE; i++) {
+			if (layouts[i].last_used < lay->last_used) lay = &layouts[i];
+		}
+	}
+	lay->text = text;
+	lay->hash = hash;
+	lay->width = width;
+	lay->line_start.clear();
+	lay->line_end.clear();
+	lay->size.x = 0;
+	lay->size.y = 0;
+	lay->last_used = ++cache_tick;
 	
-	while(segment != "" || fulltext.length() > 0) { // don't exit early on double spaces
-		builder = builder + segment;
+	// advance of each char, as in calc_length
+	int space_advance = this->width[32] + kerning;
+	int len = text.length();
+	int line_start = 0;
+	int line_advance = 0;
+	int pos = 0;
+	int word_end;
+	int word_advance;
+	int line_end;
+	int content_advance;
+	unsigned char c;
+	
+	while (true) {
+	
+		// measure the next word
+		word_end = pos;
+		word_advance = 0;
+		while (word_end < len && text[word_end] != ' ' && text[word_end] != '\n') {
+			c = text[word_end];
+			word_advance += this->width[c] + kerning;
+			word_end++;
+		}
 		
-		if (calc_length(builder) > width) {
-			height = height + line_height;
-			if (calc_length(builder_prev) > max_width) max_width = calc_length(builder_prev);
-			builder_prev = "";
-			builder = segment + " ";
+		// break before this word if it would overflow a line that already has text.
+		// line_advance + word_advance - kerning is calc_length() of the line so far
+		// plus this word, the same test the old builder loop made, and each size.x
+		// below is the old calc_length(line + " ") - width[32] - kerning.
+		if (pos > line_start && line_advance + word_advance - kerning > width) {
+			line_end = pos - 1; // drop the separating space
+			content_advance = line_advance - space_advance;
+			
+			lay->line_start.push_back(line_start);
+			lay->line_end.push_back(line_end);
+			if (line_end > line_start && content_advance - kerning > lay->size.x)
+				lay->size.x = content_advance - kerning;
+			
+			line_start = pos;
+			line_advance = 0;
 		}
-		else {
-			builder = builder + " ";
-			builder_prev = builder;
+		line_advance += word_advance;
+		
+		if (word_end < len && text[word_end] == ' ') {
+			line_advance += space_advance;
+			pos = word_end + 1;
+			continue;
 		}
 		
-		segment = eatFirstString(fulltext, space);
+		// end of text or a newline ends this line
+		lay->line_start.push_back(line_start);
+		lay->line_end.push_back(word_end);
+		if (word_end > line_start && line_advance - kerning > lay->size.x)
+			lay->size.x = line_advance - kerning;
+		
+		if (word_end == len) break;
+		
+		line_start = pos = word_end + 1;
+		line_advance = 0;
 	}
 	
-	height = height + line_height;
-	if (calc_length(builder) > max_width) max_width = calc_length(builder);
-				
-	Point size;
-	size.x = max_width - this->width[32] - kerning; // remove the extra blankspace at the end
-	size.y = height;
-	return size;
+	lay->size.y = lay->line_start.size() * line_height;
+	return lay;
+}
 
+unsigned int FontEngine::hashText(const char *text) {
+	unsigned int hash = 5381;
+	for (const char *c = text; *c; c++) {
+		hash = hash * 33 + (unsigned char)*c;
+	}
+	return hash;
 }
 
 /**
- * Render the given text at (x,y) on the target image.
- * Justify is left, right, or center
+ * Find an already composited run, or NULL. Takes a plain C string so a
+ * cache hit on arena-formatted text never builds a std::string.
  */
-void FontEngine::render(string text, int x, int y, int justify, SDL_Surface *target, int color) {
+FontCacheEntry *FontEngine::cacheFind(const char *text, int color, int width, int justify) {
+	unsigned int hash = hashText(text);
+	for (int i=0; i<cache_count; i++) {
+		if (cache[i].hash == hash && cache[i].color == color && cache[i].width == width
+				&& cache[i].justify == justify && cache[i].text == text) {
+			cache[i].last_used = ++cache_tick;
+			cache_hits++;
+			return &cache[i];
+		}
+	}
+	cache_misses++;
+	return NULL;
+}
 
-	unsigned char c;
-	char str[256];
-	int dest_x;
-	int dest_y;
+/**
+ * Return a free cache entry, evicting the least recently used run when full
+ */
+FontCacheEntry *FontEngine::cacheSlot() {
+	FontCacheEntry *slot;
 	
-	strcpy(str, text.c_str());
-
-	// calculate actual starting x,y based on justify
-	if (justify == JUSTIFY_LEFT) {
-		dest_x = x;
-		dest_y = y;
+	if (cache_count < FONT_CACHE_SIZE) {
+		slot = &cache[cache_count++];
 	}
-	else if (justify == JUSTIFY_RIGHT) {
-		dest_x = x - calc_length(text);
-		dest_y = y;
+	else {
+		slot = &cache[0];
+		for (int i=1; i<FONT_CACHE_SIZE; i++) {
+			if (cache[i].last_used < slot->last_used) slot = &cache[i];
+		}
+		if (slot->surface) SDL_FreeSurface(slot->surface);
 	}
-	else if (justify == JUSTIFY_CENTER) {
-		dest_x = x - calc_length(text)/2;
-		dest_y = y;
+	
+	slot->surface = NULL;
+	slot->last_used = ++cache_tick;
+	return slot;
+}
+
+/**
+ * Create a transparent surface in the font sheet format to composite a run into
+ */
+SDL_Surface *FontEngine::createRun(int w, int h) {
+	if (w <= 0 || h <= 0 || !sprites[FONT_WHITE]) return NULL;
+	
+	SDL_PixelFormat *fmt = sprites[FONT_WHITE]->format;
+	SDL_Surface *run = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if (!run) {
+		fprintf(stderr, "Couldn't create text surface: %s\n", SDL_GetError());
+		return NULL;
 	}
+	SDL_FillRect(run, NULL, 0);
+	SDL_SetAlpha(run, SDL_SRCALPHA, 255);
+	return run;
+}
 
-	for (unsigned int i=0; i<text.length(); i++) {
+/**
+ * Alpha-composite one glyph onto a run surface.
+ * Kerning makes neighbouring glyphs overlap, so a plain copy would cut off
+ * the previous glyph's edge; "over" gives the same result as blitting the
+ * glyphs one at a time onto the final target.
+ */
+void FontEngine::compositeGlyph(SDL_Surface *glyphs, SDL_Rect *glyph, SDL_Surface *target, int x, int y) {
+	Uint32 *src_pixel;
+	Uint32 *dest_pixel;
+	Uint8 sr, sg, sb, sa;
+	Uint8 dr, dg, db, da;
+	int out_a;
+	
+	for (int j=0; j<glyph->h; j++) {
+		if (y+j < 0 || y+j >= target->h || glyph->y+j >= glyphs->h) continue;
+		for (int i=0; i<glyph->w; i++) {
+			if (x+i < 0 || x+i >= target->w || glyph->x+i >= glyphs->w) continue;
+			
+			src_pixel = (Uint32*)glyphs->pixels + (glyph->y+j) * (glyphs->pitch/4) + glyph->x+i;
+			SDL_GetRGBA(*src_pixel, glyphs->format, &sr, &sg, &sb, &sa);
+			if (sa == 0) continue;
+			
+			dest_pixel = (Uint32*)target->pixels + (y+j) * (target->pitch/4) + x+i;
+			SDL_GetRGBA(*dest_pixel, target->format, &dr, &dg, &db, &da);
+			
+			da = da * (255-sa) / 255;
+			out_a = sa + da;
+			*dest_pixel = SDL_MapRGBA(target->format,
+				(sr*sa + dr*da) / out_a,
+				(sg*sa + dg*da) / out_a,
+				(sb*sa + db*da) / out_a,
+				out_a);
+		}
+	}
+}
+
+/**
+ * Composite one line of glyphs onto a run surface with its top-left at (x,y)
+ */
+void FontEngine::renderRun(const string &text, int x, int y, SDL_Surface *target, int color) {
+
+	unsigned char c;
+	SDL_Surface *glyphs = sprites[color];
+	if (!glyphs) return;
 	
-		// Note, SDL_BlitSurface rewrites dest to show clipping.
-		// So we have to remember dest locally.  - cpb 2010/07/03
-		dest.x = dest_x;
-		dest.y = dest_y;
+	if (SDL_MUSTLOCK(glyphs)) SDL_LockSurface(glyphs);
+	if (SDL_MUSTLOCK(target)) SDL_LockSurface(target);
+	
+	for (unsigned int i=0; i<text.length(); i++) {
 	
 		// set the bounding rect of the char to render
-		c = str[i];
+		c = text[i];
 		if (c >= 32 && c <= 127) {
 			src.x = ((c-32) % 16) * font_width;
 			src.y = ((c-32) / 16) * font_height;
 			src.w = width[c];
-		
-			// draw the font
-			SDL_BlitSurface(sprites[color], &src, target, &dest);
+			
+			compositeGlyph(glyphs, &src, target, x, y);
 		
 			// move dest
-			dest_x = dest_x + width[c] + kerning;
+			x = x + width[c] + kerning;
 		}
 	}
+	
+	if (SDL_MUSTLOCK(target)) SDL_UnlockSurface(target);
+	if (SDL_MUSTLOCK(glyphs)) SDL_UnlockSurface(glyphs);
 }
 
 /**
- * Word wrap to width
+ * Blit a cached run at dest. Menu panels carry their own alpha channel,
+ * so text drawn into one is composited instead of blended.
+ */
+void FontEngine::blitRun(SDL_Surface *run, SDL_Surface *target) {
+	if (target->format->Amask)
+		blitPanelLayer(run, NULL, target, &dest);
+	else
+		fastBlit(run, NULL, target, &dest);
+}
+
+/**
+ * Pixel width actually covered by the glyphs of this line
+ */
+static int runExtent(const string &text, int *width, int kerning) {
+	unsigned char c;
+	int x = 0;
+	int extent = 0;
+	for (unsigned int i=0; i<text.length(); i++) {
+		c = text[i];
+		if (c >= 32 && c <= 127) {
+			if (x + width[c] > extent) extent = x + width[c];
+			x = x + width[c] + kerning;
+		}
+	}
+	return extent;
+}
+
+/**
+ * Render the given text at (x,y) on the target image.
+ * Justify is left, right, or center
  */
-void FontEngine::render(string text, int x, int y, int justify, SDL_Surface *target, int width, int color) {
+void FontEngine::render(const string &text, int x, int y, int justify, SDL_Surface *target, int color) {
+	render(text.c_str(), x, y, justify, target, color);
+}
+
+void FontEngine::render(const char *text_chars, int x, int y, int justify, SDL_Surface *target, int color) {
+
+	if (text_chars[0] == '\0') return;
+
+	// one run serves every justification of the same line
+	FontCacheEntry *run = cacheFind(text_chars, color, -1, JUSTIFY_LEFT);
 	
-	cursor_y = y;
-	string segment;
-	string fulltext;
-	string builder = "";
-	string builder_prev = "";
-	char space = 32;
+	if (!run) {
+		string text(text_chars);
+		run = cacheSlot();
+		run->text = text;
+		run->hash = hashText(text_chars);
+		run->color = color;
+		run->width = -1;
+		run->justify = JUSTIFY_LEFT;
+		run->lines = 1;
+		run->offset.x = 0;
+		run->offset.y = 0;
+		run->length = calc_length(text);
+		
+		run->surface = createRun(runExtent(text, width, kerning), font_height);
+		if (run->surface) renderRun(text, 0, 0, run->surface, color);
+	}
 	
-	fulltext = text + " ";
-	segment = eatFirstString(fulltext, space);
+	if (!run->surface) return;
 	
+	// calculate actual starting x,y based on justify
+	// Note, SDL_BlitSurface rewrites dest to show clipping.
+	dest.x = x + run->offset.x;
+	if (justify == JUSTIFY_RIGHT)
+		dest.x -= run->length;
+	else if (justify == JUSTIFY_CENTER)
+		dest.x -= run->length/2;
+	dest.y = y + run->offset.y;
+	blitRun(run->surface, target);
+}
+
+/**
+ * Word wrap to width
+ */
+void FontEngine::render(const string &text, int x, int y, int justify, SDL_Surface *target, int width, int color) {
+	render(text.c_str(), x, y, justify, target, width, color);
+}
+
+void FontEngine::render(const char *text_chars, int x, int y, int justify, SDL_Surface *target, int width, int color) {
 	
-	while(segment != "" || fulltext.length() > 0) { // don't exit early on double spaces
-		builder = builder + segment;
-		
-		if (calc_length(builder) > width) {
-			render(builder_prev, x, cursor_y, justify, target, color);
-			cursor_y += line_height;
-			builder_prev = "";
-			builder = segment + " ";
+	FontCacheEntry *run = cacheFind(text_chars, color, width, justify);
+	
+	if (!run) {
+		string text(text_chars);
+		TextLayout *lay = layout(text, width);
+		vector<string> lines;
+		for (unsigned int i=0; i<lay->line_start.size(); i++) {
+			lines.push_back(text.substr(lay->line_start[i], lay->line_end[i] - lay->line_start[i]));
 		}
-		else {
-			builder = builder + " ";
-			builder_prev = builder;
+		
+		// justify each line, and find the bounds of the whole block
+		vector<int> line_x(lines.size());
+		int left = 0;
+		int right = 0;
+		bool empty = true;
+		for (unsigned int i=0; i<lines.size(); i++) {
+			int extent = runExtent(lines[i], this->width, kerning);
+			if (justify == JUSTIFY_RIGHT)
+				line_x[i] = -calc_length(lines[i]);
+			else if (justify == JUSTIFY_CENTER)
+				line_x[i] = -calc_length(lines[i])/2;
+			else
+				line_x[i] = 0;
+			
+			if (extent == 0) continue;
+			if (empty || line_x[i] < left) left = line_x[i];
+			if (empty || line_x[i] + extent > right) right = line_x[i] + extent;
+			empty = false;
 		}
 		
-		segment = eatFirstString(fulltext, space);
+		run = cacheSlot();
+		run->text = text;
+		run->hash = hashText(text_chars);
+		run->color = color;
+		run->width = width;
+		run->justify = justify;
+		run->lines = lines.size();
+		run->length = 0;
+		run->offset.x = left;
+		run->offset.y = 0;
+		
+		run->surface = createRun(right - left, (run->lines-1) * line_height + font_height);
+		if (run->surface) {
+			for (unsigned int i=0; i<lines.size(); i++) {
+				renderRun(lines[i], line_x[i] - left, i * line_height, run->surface, color);
+			}
+		}
 	}
-
-	render(builder, x, cursor_y, justify, target, color);
-	cursor_y += line_height;
+	
+	if (run->surface) {
+		dest.x = x + run->offset.x;
+		dest.y = y + run->offset.y;
+		blitRun(run->surface, target);
+	}
+	cursor_y = y + run->lines * line_height;
 
 }
 
@@ -235,5 +485,7 @@ void FontEngine::render(string text, int x, int y, int justify, SDL_Surface *tar
 FontEngine::~FontEngine() {
 	for (int i=0; i<5; i++)
 		SDL_FreeSurface(sprites[i]);
+	for (int i=0; i<cache_count; i++)
+		if (cache[i].surface) SDL_FreeSurface(cache[i].surface);
 }
 
@@ -13,6 +13,7 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include "SDL.h"
 #include "SDL_image.h"
 #include "Utils.h"
@@ -31,6 +32,40 @@ const int FONT_BLUE = 3;
 const int FONT_GRAY = 4;
 const int FONT_GREY = 4;
 
+const int FONT_CACHE_SIZE = 256;
+const int FONT_LAYOUT_CACHE_SIZE = 256;
+
+/**
+ * Line breaks for a string wrapped to a given width.
+ * Line i is text.substr(line_start[i], line_end[i] - line_start[i])
+ */
+struct TextLayout {
+	string text;
+	unsigned int hash;
+	int width;
+	vector<int> line_start;
+	vector<int> line_end;
+	Point size;
+	int last_used;
+};
+
+/**
+ * A string run already composited from the glyph sheet.
+ * Unchanged text (labels, stat values, tooltips) then costs one blit per frame.
+ */
+struct FontCacheEntry {
+	string text;
+	unsigned int hash;
+	int color;
+	int width; // wrap width, or -1 for a single line
+	int justify; // wrapped text only; single lines are justified when blitted
+	SDL_Surface *surface;
+	Point offset; // surface position relative to the render x,y, before justifying
+	int length; // calc_length() of a single line
+	int lines;
+	int last_used;
+};
+
 class FontEngine {
 private:
 	SDL_Surface *sprites[5];
@@ -40,20 +75,42 @@ private:
 	int width[256]; // width of each ASCII character
 	SDL_Rect src;
 	SDL_Rect dest;
+	
+	FontCacheEntry cache[FONT_CACHE_SIZE];
+	int cache_count;
+	int cache_tick;
+	
+	unsigned int hashText(const char *text);
+	FontCacheEntry *cacheFind(const char *text, int color, int width, int justify);
+	FontCacheEntry *cacheSlot();
+	
+	TextLayout layouts[FONT_LAYOUT_CACHE_SIZE];
+	int layout_count;
+	SDL_Surface *createRun(int w, int h);
+	void renderRun(const string &text, int x, int y, SDL_Surface *target, int color);
+	void compositeGlyph(SDL_Surface *glyphs, SDL_Rect *glyph, SDL_Surface *target, int x, int y);
+	void blitRun(SDL_Surface *run, SDL_Surface *target);
 
 public:
 	FontEngine();
 	~FontEngine();
 	void load();
 
-	int calc_length(string text);
+	int calc_length(const string &text);
 	Point calc_size(string text_with_newlines, int width);
+	TextLayout *layout(const string &text, int width);
 	
-	void render(string text, int x, int y, int justify, SDL_Surface *target, int color);
-	void render(string text, int x, int y, int justify, SDL_Surface *target, int width, int color);
+	void render(const string &text, int x, int y, int justify, SDL_Surface *target, int color);
+	void render(const string &text, int x, int y, int justify, SDL_Surface *target, int width, int color);
+	void render(const char *text, int x, int y, int justify, SDL_Surface *target, int color);
+	void render(const char *text, int x, int y, int justify, SDL_Surface *target, int width, int color);
 	
 	int cursor_y;
 	int line_height;
+	
+	// cache statistics
+	int cache_hits;
+	int cache_misses;
 };
 
 #endif
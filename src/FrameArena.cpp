@@ -0,0 +1,88 @@
+/**
+ * class FrameArena
+ *
+ * Scratch memory for data that only lives until the end of the frame,
+ * e.g. formatted HUD strings. Allocation bumps a pointer; GameEngine
+ * resets the whole arena after each render.
+ *
+ * Also counts every heap allocation in the program, from any thread, so
+ * per-frame allocations can be watched.
+ *
+ * @license GPL
+ */
+
+#include "FrameArena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <new>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+FrameArena frame_arena;
+volatile long heap_allocs = 0;
+
+FrameArena::FrameArena() {
+	used = 0;
+	peak = 0;
+}
+
+/**
+ * Returns NULL if this frame has used up the arena
+ */
+void *FrameArena::alloc(int size) {
+	size = (size + 7) & ~7; // keep allocations 8-byte aligned
+	if (used + size > FRAME_ARENA_SIZE) {
+		fprintf(stderr, "Frame arena full (%d bytes)\n", FRAME_ARENA_SIZE);
+		return NULL;
+	}
+	void *p = buffer + used;
+	used += size;
+	if (used > peak) peak = used;
+	return p;
+}
+
+/**
+ * printf into the arena. The string is valid until the end of the frame.
+ */
+const char *FrameArena::format(const char *fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+	if (len < 0) return "";
+	
+	char *s = (char *)alloc(len + 1);
+	if (!s) return "";
+	
+	va_start(args, fmt);
+	vsnprintf(s, len + 1, fmt, args);
+	va_end(args);
+	return s;
+}
+
+void FrameArena::reset() {
+	used = 0;
+}
+
+/**
+ * Global allocation hooks, only here to count heap allocations.
+ * new[] and delete[] go through these by default. Worker threads
+ * allocate too, so the count is bumped atomically.
+ */
+void *operator new(size_t size) {
+#ifdef _MSC_VER
+	_InterlockedIncrement(&heap_allocs);
+#else
+	__sync_fetch_and_add(&heap_allocs, 1);
+#endif
+	void *p = malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) throw() {
+	free(p);
+}
@@ -0,0 +1,38 @@
+/**
+ * class FrameArena
+ *
+ * Scratch memory for data that only lives until the end of the frame,
+ * e.g. formatted HUD strings. Allocation bumps a pointer; GameEngine
+ * resets the whole arena after each render.
+ *
+ * Also counts every heap allocation in the program, from any thread, so
+ * per-frame allocations can be watched.
+ *
+ * @license GPL
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+const int FRAME_ARENA_SIZE = 65536;
+
+class FrameArena {
+private:
+	char buffer[FRAME_ARENA_SIZE];
+	int used;
+
+public:
+	FrameArena();
+	void *alloc(int size);
+	const char *format(const char *fmt, ...);
+	void reset();
+	
+	int peak; // most bytes used in a single frame
+};
+
+extern FrameArena frame_arena;
+
+// total heap allocations (operator new) since startup
+extern volatile long heap_allocs;
+
+#endif
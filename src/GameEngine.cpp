@@ -20,15 +20,28 @@ GameEngine::GameEngine(SDL_Surface *_screen, InputState *_inp, FontEngine *_font
 	done = false;
 	npc_id = -1;
 	game_slot = 0;
+	frame_allocs = 0;
+	alloc_mark = heap_allocs;
+	fps = 0;
+	fps_frames = 0;
+	fps_ticks = SDL_GetTicks();
+	front = &snapshots[0];
+	back = &snapshots[1];
+	front->count = back->count = 0;
+	snapshot_stale = true;
+	world_running = false;
+	tick_action = -1;
+	tick_restrict = false;
 
 	// construct gameplay objects
+	tasks = new TaskScheduler(WORKER_THREADS);
 	powers = new PowerManager();
 	font = _font;
 	camp = new CampaignManager();
-	map = new MapIso(_screen, camp);
+	map = new MapIso(_screen, camp, tasks);
 	pc = new Avatar(powers, _inp, map);
 	enemies = new EnemyManager(powers, map);
-	hazards = new HazardManager(powers, pc, enemies);
+	hazards = new HazardManager(powers, pc, enemies, tasks);
 	menu = new MenuManager(powers, _screen, _inp, font, &pc->stats, camp);
 	loot = new LootManager(menu->items, menu->tip, enemies, map);
 	npcs = new NPCManager(map, menu->tip, loot, menu->items);
@@ -58,6 +71,7 @@ void GameEngine::resetGame() {
 	menu->log->clear();
 	quests->createQuestList();
 	menu->hudlog->clear();
+	snapshot_stale = true;
 }
 
 /**
@@ -149,6 +163,8 @@ void GameEngine::checkTeleport() {
 			powers->handleNewMap(&map->collider);
 			menu->enemy->handleNewMap();
 			npcs->handleNewMap();
+			snapshot_stale = true;
+			menu->mini->prerender(&map->collider, map->w, map->h);
 			menu->vendor->npc = NULL;
 			menu->vendor->visible = false;
 			npc_id = -1;
@@ -227,6 +243,7 @@ void GameEngine::checkEquipmentChange() {
 		                 menu->items->items[menu->inv->inventory[EQUIPMENT][1].item].gfx, 
 		                 menu->items->items[menu->inv->inventory[EQUIPMENT][2].item].gfx);
 		menu->inv->changed_equipment = false;
+		snapshot_stale = true;
 	}
 }
 
@@ -321,12 +338,102 @@ void GameEngine::checkNPCInteraction() {
 
 }
 
+/**
+ * Map events can change collision tiles.
+ * Pass those changes on to the objects that cache collision data.
+ */
+void GameEngine::checkMapMods() {
+	Point mod;
+	while (!map->collision_mods.empty()) {
+		mod = map->collision_mods.front();
+		map->collision_mods.pop();
+		menu->mini->update(mod.x, mod.y);
+		map->collider.invalidate_visibility();
+		map->pathfinder.invalidate();
+	}
+}
+
+void GameEngine::worldTick(void *data, int, int) {
+	((GameEngine *)data)->tickWorld();
+}
+
+/**
+ * Advance the simulation one tick and fill the back snapshot.
+ * Runs on a worker while render() draws the front snapshot, so it must not
+ * touch the menus, the input state or anything render() reads live.
+ */
+void GameEngine::tickWorld() {
+
+	// new node budget for path searches; the hero and enemies share it
+	map->pathfinder.logic();
+	
+	pc->logic(tick_action, tick_restrict);
+	
+	// transfer hero data to enemies, for AI use
+	enemies->hero_pos = pc->stats.pos;
+	enemies->hero_alive = pc->stats.alive;
+	map->collider.update_visibility(pc->stats.pos.x, pc->stats.pos.y);
+	if (pc->stats.alive) map->pathfinder.updateFlowField(pc->stats.pos, enemies->chaseReach());
+	
+	enemies->logic();
+	hazards->logic();
+	
+	loot->logic();
+	enemies->checkEnemiesforXP(&pc->stats);
+	npcs->logic();
+	
+	snapshot(back);
+}
+
+/**
+ * Wait for the world tick in flight, then make its snapshot the one to draw.
+ * What the tick can't do beside render() happens here, on the main thread:
+ * its sounds, and map events, which can change the tiles and the camera.
+ */
+void GameEngine::finishWorld() {
+	if (!world_running) return;
+	
+	tasks->wait(&world_group);
+	world_running = false;
+	
+	sound_queue.release();
+	map->checkEvents(pc->stats.pos);
+	
+	RenderSnapshot *temp = front;
+	front = back;
+	back = temp;
+}
+
 /**
  * Process all actions for a single frame
  * This includes some message passing between child object
+ * The world simulation is only started here; render() waits for it.
  */
 void GameEngine::logic() {
 
+	finishWorld();
+	
+	// results of the last world tick.
+	// these actions occur whether the game is paused or not.
+	checkLootDrop();
+	checkTeleport();
+	checkLog();
+	checkEquipmentChange();
+	checkConsumable();
+	checkMapMods();
+	checkCancel();
+
+	map->logic();
+	quests->logic();
+	
+	// teleports and equipment changes free graphics the front snapshot still uses
+	if (snapshot_stale) {
+		snapshot(front);
+		snapshot_stale = false;
+	}
+	
+	if (done) return;
+	
 	// check menus first (top layer gets mouse click priority)
 	menu->logic();
 	
@@ -337,101 +444,132 @@ void GameEngine::logic() {
 		checkEnemyFocus();
 		checkNPCInteraction();
 		
-		pc->logic(menu->act->checkAction(inp->mouse), restrictPowerUse());
-		
-		// transfer hero data to enemies, for AI use
-		enemies->hero_pos = pc->stats.pos;
-		enemies->hero_alive = pc->stats.alive;
-		
-		enemies->logic();
-		hazards->logic();
-		loot->logic();
-		enemies->checkEnemiesforXP(&pc->stats);
-		npcs->logic();
+		tick_action = menu->act->checkAction(inp->mouse);
+		tick_restrict = restrictPowerUse();
 		
+		sound_queue.hold();
+		tasks->run(worldTick, this, &world_group);
+		world_running = true;
 	}
 	
-	// these actions occur whether the game is paused or not.
-	checkLootDrop();
-	checkTeleport();
-	checkLog();
-	checkEquipmentChange();
-	checkConsumable();
-	checkCancel();
-
-	map->logic();
-	quests->logic();
-	
 }
 
-
 /**
- * Render all graphics for a single frame
+ * Gather and sort the renderables of every object not already on the map
  */
-void GameEngine::render() {
+void GameEngine::snapshot(RenderSnapshot *s) {
 
-	// Create a list of Renderables from all objects not already on the map.
-	renderableCount = 0;
+	Renderable *r = s->r;
+	int renderableCount = 0;
 
+	// the hero and its overlays first, so a crowded frame drops hazards instead
 	r[renderableCount++] = pc->getRender(); // Avatar
 	
+	if (pc->stats.shield_hp > 0) {
+		r[renderableCount] = pc->stats.getEffectRender(STAT_EFFECT_SHIELD);
+		r[renderableCount++].sprite = powers->gfx[powers->powers[POWER_SHIELD].gfx_index]; // TODO: parameter
+	}
+	if (pc->stats.vengeance_stacks > 0) {
+		r[renderableCount] = pc->stats.getEffectRender(STAT_EFFECT_VENGEANCE);
+		r[renderableCount++].sprite = powers->runes;		
+	}
+	
 	for (int i=0; i<enemies->enemy_count; i++) { // Enemies
-		r[renderableCount++] = enemies->getRender(i);
-		if (enemies->enemies[i]->stats.shield_hp > 0) {
+		if (renderableCount < MAX_RENDERABLES) r[renderableCount++] = enemies->getRender(i);
+		if (enemies->enemies[i]->stats.shield_hp > 0 && renderableCount < MAX_RENDERABLES) {
 			r[renderableCount] = enemies->enemies[i]->stats.getEffectRender(STAT_EFFECT_SHIELD);
 			r[renderableCount++].sprite = powers->gfx[powers->powers[POWER_SHIELD].gfx_index]; // TODO: parameter
 		}
 	}
 
 	for (int i=0; i<npcs->npc_count; i++) { // NPCs
-		r[renderableCount++] = npcs->npcs[i]->getRender();
+		if (renderableCount < MAX_RENDERABLES) r[renderableCount++] = npcs->npcs[i]->getRender();
 	}
 	
 	for (int i=0; i<loot->loot_count; i++) { // Loot
-		r[renderableCount++] = loot->getRender(i);
+		if (renderableCount < MAX_RENDERABLES) r[renderableCount++] = loot->getRender(i);
 	}
 	
 	for (int i=0; i<hazards->hazard_count; i++) { // Hazards
-		if (hazards->h[i]->rendered && hazards->h[i]->delay_frames == 0) {
+		if (hazards->h[i]->rendered && hazards->h[i]->delay_frames == 0 && renderableCount < MAX_RENDERABLES) {
 			r[renderableCount++] = hazards->getRender(i);
 		}
 	}
-	
-	// get additional hero overlays
-	if (pc->stats.shield_hp > 0) {
-		r[renderableCount] = pc->stats.getEffectRender(STAT_EFFECT_SHIELD);
-		r[renderableCount++].sprite = powers->gfx[powers->powers[POWER_SHIELD].gfx_index]; // TODO: parameter
-	}
-	if (pc->stats.vengeance_stacks > 0) {
-		r[renderableCount] = pc->stats.getEffectRender(STAT_EFFECT_VENGEANCE);
-		r[renderableCount++].sprite = powers->runes;		
-	}
 		
 	sort_by_tile(r,renderableCount);
+	
+	s->count = renderableCount;
+	s->cam = map->cam;
+	s->hero_pos = pc->stats.pos;
+}
+
+
+/**
+ * Render all graphics for a single frame
+ */
+void GameEngine::render() {
+
+	// draw the last finished tick while the next one runs
+	RenderSnapshot *view = front;
 
 	// render the static map layers plus the renderables
-	map->render(r, renderableCount);
+	map->render(view->r, view->count, view->cam);
 	
 	// display the name of the map in the upper-right hand corner
 	font->render(map->title, VIEW_W-2, 2, JUSTIFY_RIGHT, screen, FONT_WHITE);
 	
+	// the tooltips and HUD read live game state
+	finishWorld();
+	
 	// mouseover tooltips
-	loot->renderTooltips(map->cam);
-	npcs->renderTooltips(map->cam, inp->mouse);
+	loot->renderTooltips(view->cam);
+	npcs->renderTooltips(view->cam, inp->mouse);
 	
 	menu->hudlog->render();
-	menu->mini->render(&map->collider, pc->stats.pos, map->w, map->h);
+	menu->mini->render(view->hero_pos);
 	menu->render();
+	
+	if (SHOW_FPS) {
+		fps_frames++;
+		if (SDL_GetTicks() - fps_ticks >= 1000) {
+			fps = fps_frames;
+			fps_frames = 0;
+			fps_ticks = SDL_GetTicks();
+		}
+		showFPS(fps);
+	}
 
+	// end of frame: count this frame's heap allocations and drop its scratch memory
+	long allocs = heap_allocs;
+	frame_allocs = allocs - alloc_mark;
+	alloc_mark = allocs;
+	frame_arena.reset();
 }
 
+/**
+ * Frame rate and engine counters, under show_fps=1 in settings.txt:
+ * fps and heap allocations during the last frame, enemy tiers, text
+ * cache and pathfinder counters. The world tick has finished by now,
+ * so its counters are safe to read.
+ */
 void GameEngine::showFPS(int fps) {
-	stringstream ss;
-	ss << fps << "fps";
-	font->render(ss.str(), VIEW_W >> 1, 2, JUSTIFY_CENTER, screen, FONT_GRAY); 
+	int y = 2;
+	font->render(frame_arena.format("%dfps %d allocs", fps, frame_allocs), VIEW_W >> 1, y, JUSTIFY_CENTER, screen, FONT_GRAY);
+	y += font->line_height;
+	font->render(frame_arena.format("enemies %d active %d near %d dormant",
+		enemies->tier_count[AI_TIER_ACTIVE], enemies->tier_count[AI_TIER_NEAR], enemies->tier_count[AI_TIER_DORMANT]),
+		VIEW_W >> 1, y, JUSTIFY_CENTER, screen, FONT_GRAY);
+	y += font->line_height;
+	font->render(frame_arena.format("text cache %d hits %d misses", font->cache_hits, font->cache_misses),
+		VIEW_W >> 1, y, JUSTIFY_CENTER, screen, FONT_GRAY);
+	y += font->line_height;
+	font->render(frame_arena.format("paths %d nodes %d cached %d flow builds",
+		map->pathfinder.nodes_expanded, map->pathfinder.cache_hits, map->pathfinder.flow_builds),
+		VIEW_W >> 1, y, JUSTIFY_CENTER, screen, FONT_GRAY);
 }
 
 GameEngine::~GameEngine() {
+	finishWorld();
 	delete quests;
 	delete camp;
 	delete npcs;
@@ -442,4 +580,5 @@ GameEngine::~GameEngine() {
 	delete menu;
 	delete loot;
 	delete powers;
+	delete tasks;
 }
@@ -27,6 +27,20 @@
 #include "NPCManager.h"
 #include "CampaignManager.h"
 #include "QuestLog.h"
+#include "FrameArena.h"
+#include "TaskScheduler.h"
+#include "SoundQueue.h"
+
+/**
+ * What the world render needs from one logic tick.
+ * Renderables are already sorted into map draw order.
+ */
+struct RenderSnapshot {
+	Renderable r[MAX_RENDERABLES];
+	int count;
+	Point cam;
+	Point hero_pos;
+};
 
 class GameEngine {
 private:
@@ -36,8 +50,6 @@ private:
 	Avatar *pc;
 	MapIso *map;
 	Enemy *enemy;
-	Renderable r[1024];
-	int renderableCount;
 	HazardManager *hazards;
 	EnemyManager *enemies;
 	FontEngine *font;
@@ -47,6 +59,18 @@ private:
 	NPCManager *npcs;
 	CampaignManager *camp;
 	QuestLog *quests;
+	TaskScheduler *tasks;
+	long alloc_mark; // heap_allocs at the end of the last frame
+	
+	// the world tick runs on a worker while the last tick's snapshot is drawn
+	RenderSnapshot snapshots[2];
+	RenderSnapshot *front; // being drawn
+	RenderSnapshot *back; // being filled by the world tick
+	bool snapshot_stale; // front points at freed graphics
+	TaskGroup world_group;
+	bool world_running;
+	int tick_action; // hero input, read before the tick starts
+	bool tick_restrict;
 	
 	bool restrictPowerUse();
 	void checkEnemyFocus();
@@ -58,6 +82,11 @@ private:
 	void checkEquipmentChange();
 	void checkConsumable();
 	void checkNPCInteraction();
+	void checkMapMods();
+	static void worldTick(void *data, int begin, int end);
+	void tickWorld();
+	void finishWorld();
+	void snapshot(RenderSnapshot *s);
 	
 public:
 	GameEngine(SDL_Surface *screen, InputState *inp, FontEngine *font);
@@ -73,6 +102,10 @@ public:
 	bool done;
 	int npc_id;
 	int game_slot;
+	int frame_allocs; // heap allocations during the last frame
+	int fps; // frames drawn during the last second
+	int fps_frames;
+	Uint32 fps_ticks;
 
 };
 
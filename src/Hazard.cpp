@@ -12,8 +12,11 @@
 
 Hazard::Hazard() {
 	sprites = NULL;
+	atlas = NULL;
 	speed.x = 0.0;
 	speed.y = 0.0;
+	pos.x = pos.y = 0.0;
+	path_start.x = path_start.y = 0.0;
 	direction = 0;
 	visual_option = 0;
 	multitarget = false;
@@ -56,6 +59,8 @@ void Hazard::setCollision(MapCollision *_collider) {
 
 void Hazard::logic() {
 	
+	path_start = pos;
+	
 	// if the hazard is on delay, take no action
 	if (delay_frames > 0) {
 		delay_frames--;
@@ -72,15 +77,58 @@ void Hazard::logic() {
 		pos.x += speed.x;
 		pos.y += speed.y;
 		
-		// very simplified collider, could skim around corners
-		// or even pass through thin walls if speed > tilesize
-		if (collider->is_wall(round(pos.x), round(pos.y))) {
+		// sweep the whole path through the tile grid, so fast missiles
+		// can't skip over thin walls or corners
+		if (!collider->line_of_sight(round(path_start.x), round(path_start.y), round(pos.x), round(pos.y))) {
 			lifespan = 0;
 			hit_wall = true;
 			
-			if (collider->outsideMap(round(pos.x) >> TILE_SHIFT, round(pos.y) >> TILE_SHIFT))
+			// stop at the first impact point
+			pos.x = collider->result_x;
+			pos.y = collider->result_y;
+			
+			if (collider->outsideMap(collider->result_tile.x, collider->result_tile.y))
 				remove_now = true;
 		}
 	}
 
 }
+
+/**
+ * Did this tick's path pass within radius of the target?
+ * Stationary hazards reduce to a plain distance check.
+ */
+bool Hazard::pathHits(Point target) {
+	Point start = round(path_start);
+	Point end = round(pos);
+	
+	if (start.x == end.x && start.y == end.y)
+		return isWithin(end, radius, target);
+	
+	// closest point on the path to the target
+	float dx = end.x - start.x;
+	float dy = end.y - start.y;
+	float t = ((target.x - start.x) * dx + (target.y - start.y) * dy) / (dx*dx + dy*dy);
+	if (t < 0) t = 0;
+	else if (t > 1) t = 1;
+	
+	FPoint closest;
+	closest.x = start.x + t * dx;
+	closest.y = start.y + t * dy;
+	return isWithin(round(closest), radius, target);
+}
+
+/**
+ * Box around everything pathHits() could hit this tick, for cheap rejection
+ */
+SDL_Rect Hazard::pathBounds() {
+	Point start = round(path_start);
+	Point end = round(pos);
+	
+	SDL_Rect r;
+	r.x = (start.x < end.x ? start.x : end.x) - radius;
+	r.y = (start.y < end.y ? start.y : end.y) - radius;
+	r.w = abs(end.x - start.x) + radius + radius + 1;
+	r.h = abs(end.y - start.y) + radius + radius + 1;
+	return r;
+}
@@ -16,6 +16,7 @@
 #include "SDL_mixer.h"
 #include "Utils.h"
 #include "MapCollision.h"
+#include "SpriteAtlas.h"
 
 // Hazard Sources
 const int SRC_HERO = 0;
@@ -29,8 +30,11 @@ public:
 	Hazard();
 	
 	SDL_Surface *sprites;
+	SpriteAtlas *atlas; // packed frames of sprites, if any
 	void setCollision(MapCollision *_collider);
 	void logic();
+	bool pathHits(Point target);
+	SDL_Rect pathBounds();
 
 	int source;
 	int enemyIndex;
@@ -41,6 +45,7 @@ public:
 	int accuracy;
 	
 	FPoint pos;
+	FPoint path_start; // where pos was at the start of this tick
 	FPoint speed;
 	int base_speed;
 	int lifespan; // ticks down to zero
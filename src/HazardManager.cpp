@@ -2,6 +2,7 @@
  * class HazardManager
  *
  * Holds the collection of hazards (active attacks, spells, etc) and handles group operations
+ * The hazards themselves live in PowerManager's HazardPool.
  *
  * @author Clint Bellanger
  * @license GPL
@@ -9,10 +10,11 @@
 
 #include "HazardManager.h"
 
-HazardManager::HazardManager(PowerManager *_powers, Avatar *_hero, EnemyManager *_enemies) {
+HazardManager::HazardManager(PowerManager *_powers, Avatar *_hero, EnemyManager *_enemies, TaskScheduler *_tasks) {
 	powers = _powers;
 	hero = _hero;
 	enemies = _enemies;
+	tasks = _tasks;
 	hazard_count = 0;
 }
 
@@ -31,8 +33,10 @@ void HazardManager::logic() {
 		h[i]->logic();
 		
 		// remove all hazards that need to die immediately (e.g. exit the map)
-		if (h[i]->remove_now)
+		if (h[i]->remove_now) {
 			expire(i);
+			continue;
+		}
 		
 		
 		// if a moving hazard hits a wall, check for an after-effect
@@ -53,17 +57,26 @@ void HazardManager::logic() {
 	
 	bool hit;
 	
+	// find candidate enemies for every hazard at once, on the worker threads
+	unsigned int stride = enemies->enemy_count;
+	if (candidates.size() < hazard_count * stride) candidates.resize(hazard_count * stride);
+	if (candidate_count.size() < (unsigned int)hazard_count) candidate_count.resize(hazard_count);
+	TaskGroup broad;
+	tasks->parallelFor(broadPhase, this, hazard_count, HAZARD_BROAD_GRAIN, &broad);
+	tasks->wait(&broad);
+	
 	// handle collisions
 	for (int i=0; i<hazard_count; i++) {
 		if (h[i]->active && h[i]->delay_frames==0 && (h[i]->active_frame == -1 || h[i]->active_frame == h[i]->frame)) {
 	
 			// process hazards that can hurt enemies
 			if (h[i]->source == SRC_HERO || h[i]->source == SRC_NEUTRAL) {
-				for (int eindex = 0; eindex < enemies->enemy_count; eindex++) {
+				for (int k = 0; k < candidate_count[i]; k++) {
+					int eindex = candidates[i * stride + k];
 			
 					// only check living enemies
 					if (enemies->enemies[eindex]->stats.hp > 0 && h[i]->active) {
-						if (isWithin(round(h[i]->pos), h[i]->radius, enemies->enemies[eindex]->stats.pos)) {
+						if (h[i]->pathHits(enemies->enemies[eindex]->stats.pos)) {
 							// hit!
 							hit = enemies->enemies[eindex]->takeHit(*h[i]);
 							if (!h[i]->multitarget && hit) {
@@ -79,7 +92,7 @@ void HazardManager::logic() {
 			// process hazards that can hurt the hero
 			if (h[i]->source == SRC_ENEMY || h[i]->source == SRC_NEUTRAL) {
 				if (hero->stats.hp > 0 && h[i]->active) {
-					if (isWithin(round(h[i]->pos), h[i]->radius, hero->stats.pos)) {
+					if (h[i]->pathHits(hero->stats.pos)) {
 						// hit!
 						hit = hero->takeHit(*h[i]);
 						if (!h[i]->multitarget && hit) {
@@ -94,6 +107,34 @@ void HazardManager::logic() {
 	}
 }
 
+bool HazardManager::hurtsEnemies(Hazard *haz) {
+	if (!haz->active || haz->delay_frames != 0) return false;
+	if (haz->active_frame != -1 && haz->active_frame != haz->frame) return false;
+	return haz->source == SRC_HERO || haz->source == SRC_NEUTRAL;
+}
+
+/**
+ * For hazards [begin, end): list the living enemies inside each hazard's path
+ * bounds, from the packed enemy arrays. Only reads shared state.
+ */
+void HazardManager::broadPhase(void *data, int begin, int end) {
+	HazardManager *hm = (HazardManager *)data;
+	EnemyManager *e = hm->enemies;
+	int stride = e->enemy_count;
+	
+	for (int i=begin; i<end; i++) {
+		int n = 0;
+		if (hm->hurtsEnemies(hm->h[i])) {
+			SDL_Rect bounds = hm->h[i]->pathBounds();
+			for (int eindex = 0; eindex < stride; eindex++) {
+				if (e->hot_hp[eindex] > 0 && isWithin(bounds, e->hot_pos[eindex]))
+					hm->candidates[i * stride + n++] = eindex;
+			}
+		}
+		hm->candidate_count[i] = n;
+	}
+}
+
 /**
  * Look for hazards generated this frame
  * TODO: all these hazards will originate from PowerManager instead
@@ -101,41 +142,34 @@ void HazardManager::logic() {
 void HazardManager::checkNewHazards() {
 
 	Hazard *new_haz;
+	int handle;
 
 	// check PowerManager for hazards
 	while (!powers->hazards.empty()) {
-		new_haz = powers->hazards.front();		
-		powers->hazards.pop();		
+		handle = powers->hazards.front();
+		powers->hazards.pop();
+		
+		// stale if the pool was cleared since (map change)
+		new_haz = powers->hazard_pool.get(handle);
+		if (new_haz == NULL) continue;
 		new_haz->setCollision(collider);
 
-		h[hazard_count] = new_haz;
-		hazard_count++;
-	}
-
-	// check hero hazards
-	if (hero->haz != NULL) {
-		h[hazard_count] = hero->haz;
+		h.push_back(new_haz);
+		handles.push_back(handle);
 		hazard_count++;
-		hero->haz = NULL;
-	}
-	
-	// check monster hazards
-	for (int eindex = 0; eindex < enemies->enemy_count; eindex++) {
-		if (enemies->enemies[eindex]->haz != NULL) {
-			h[hazard_count] = enemies->enemies[eindex]->haz;
-			hazard_count++;
-			enemies->enemies[eindex]->haz = NULL;
-		}
 	}
 }
 
 void HazardManager::expire(int index) {
 	// TODO: assert this instead?
 	if (index >= 0 && index < hazard_count) {
-		delete(h[index]);
-		for (int i=index; i<hazard_count-1; i++) {
-			h[i] = h[i+1];
-		}
+		powers->hazard_pool.release(handles[index]);
+		
+		// the last hazard takes this one's place
+		h[index] = h.back();
+		handles[index] = handles.back();
+		h.pop_back();
+		handles.pop_back();
 		hazard_count--;
 	}
 }
@@ -144,6 +178,9 @@ void HazardManager::expire(int index) {
  * Reset all hazards and get new collision object
  */
 void HazardManager::handleNewMap(MapCollision *_collider) {
+	powers->hazard_pool.clear();
+	h.clear();
+	handles.clear();
 	hazard_count = 0;
 	collider = _collider;
 }
@@ -165,6 +202,7 @@ Renderable HazardManager::getRender(int haz_id) {
 	r.offset.x = h[haz_id]->frame_offset.x;
 	r.offset.y = h[haz_id]->frame_offset.y;
 	r.object_layer = !h[haz_id]->floor;
+	r.flip = false;
 
 	if (h[haz_id]->direction > 0)
 		r.src.y = h[haz_id]->frame_size.y * h[haz_id]->direction;
@@ -173,11 +211,11 @@ Renderable HazardManager::getRender(int haz_id) {
 	else
 		r.src.y = 0;
 	
+	if (h[haz_id]->atlas) h[haz_id]->atlas->lookup(r);
+	
 	return r;
 }
 
 HazardManager::~HazardManager() {
-	for (int i=0; i<hazard_count; i++) {
-		delete h[i];
-	}
+	// the hazards belong to PowerManager's pool
 }
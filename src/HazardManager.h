@@ -2,6 +2,7 @@
  * class HazardManager
  *
  * Holds the collection of hazards (active attacks, spells, etc) and handles group operations
+ * The hazards themselves live in PowerManager's HazardPool.
  *
  * @author Clint Bellanger
  * @license GPL
@@ -16,6 +17,13 @@
 #include "Hazard.h"
 #include "MapCollision.h"
 #include "PowerManager.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+const int HAZARD_BROAD_GRAIN = 16; // hazards per broad phase task
+
+using namespace std;
 
 class HazardManager {
 private:
@@ -23,8 +31,15 @@ private:
 	EnemyManager *enemies;
 	MapCollision *collider;
 	PowerManager *powers;
+	TaskScheduler *tasks;
+	
+	// broad phase results: enemies each hazard might hit, hazard i at [i * enemy_count]
+	vector<int> candidates;
+	vector<int> candidate_count;
+	static void broadPhase(void *data, int begin, int end);
+	bool hurtsEnemies(Hazard *haz);
 public:
-	HazardManager(PowerManager *_powers, Avatar *_hero, EnemyManager *_enemies);
+	HazardManager(PowerManager *_powers, Avatar *_hero, EnemyManager *_enemies, TaskScheduler *_tasks);
 	~HazardManager();
 	void logic();
 	void expire(int index);
@@ -33,7 +48,8 @@ public:
 	Renderable getRender(int haz_id);
 	
 	int hazard_count;
-	Hazard *h[256];
+	vector<Hazard *> h; // live hazards, in no particular order
+	vector<int> handles; // pool handle for each entry of h
 };
 
 #endif
@@ -0,0 +1,92 @@
+/**
+ * class HazardPool
+ *
+ * Storage for every hazard in play. Hazards live in fixed-size chunks that
+ * are never moved or freed until shutdown, and released slots are reused.
+ * A handle carries its slot's generation, so a handle to a released hazard
+ * can't reach whatever occupies the slot next.
+ *
+ * @license GPL
+ */
+
+#include "HazardPool.h"
+
+HazardPool::HazardPool() {
+	live_count = 0;
+}
+
+/**
+ * Add another chunk of free slots
+ */
+void HazardPool::grow() {
+	int first = chunks.size() * HAZARD_CHUNK_SIZE;
+	if (first + HAZARD_CHUNK_SIZE > HAZARD_SLOT_MASK + 1) {
+		fprintf(stderr, "Hazard pool is full at %d hazards\n", first);
+		return;
+	}
+	
+	chunks.push_back(new Hazard[HAZARD_CHUNK_SIZE]);
+	
+	// hand out low slots first
+	for (int i=first+HAZARD_CHUNK_SIZE-1; i>=first; i--) {
+		generation.push_back(0);
+		free_slots.push_back(i);
+	}
+}
+
+Hazard *HazardPool::slot(int index) {
+	return &chunks[index / HAZARD_CHUNK_SIZE][index % HAZARD_CHUNK_SIZE];
+}
+
+/**
+ * Take a slot and reset it to a new Hazard.
+ * Returns its handle, or -1 if the pool can't grow any further.
+ */
+int HazardPool::alloc() {
+	if (free_slots.empty()) grow();
+	if (free_slots.empty()) return -1;
+	
+	int index = free_slots.back();
+	free_slots.pop_back();
+	*slot(index) = Hazard();
+	live_count++;
+	return index | ((generation[index] & 0x7fff) << HAZARD_SLOT_BITS);
+}
+
+/**
+ * The hazard behind a handle, or NULL if it has been released since
+ */
+Hazard *HazardPool::get(int handle) {
+	if (handle < 0) return NULL;
+	int index = handle & HAZARD_SLOT_MASK;
+	if (index >= (int)generation.size()) return NULL;
+	if ((generation[index] & 0x7fff) != (handle >> HAZARD_SLOT_BITS)) return NULL;
+	return slot(index);
+}
+
+void HazardPool::release(int handle) {
+	if (get(handle) == NULL) return;
+	int index = handle & HAZARD_SLOT_MASK;
+	generation[index]++;
+	free_slots.push_back(index);
+	live_count--;
+}
+
+/**
+ * Release every hazard at once (e.g. on map change).
+ * Outstanding handles all become stale.
+ */
+void HazardPool::clear() {
+	free_slots.clear();
+	for (int i=generation.size()-1; i>=0; i--) {
+		generation[i]++;
+		free_slots.push_back(i);
+	}
+	live_count = 0;
+}
+
+HazardPool::~HazardPool() {
+	for (unsigned int i=0; i<chunks.size(); i++) {
+		delete[] chunks[i];
+	}
+}
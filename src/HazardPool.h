@@ -0,0 +1,45 @@
+/**
+ * class HazardPool
+ *
+ * Storage for every hazard in play. Hazards live in fixed-size chunks that
+ * are never moved or freed until shutdown, and released slots are reused.
+ * A handle carries its slot's generation, so a handle to a released hazard
+ * can't reach whatever occupies the slot next.
+ *
+ * @license GPL
+ */
+
+#ifndef HAZARD_POOL_H
+#define HAZARD_POOL_H
+
+#include <vector>
+#include "Hazard.h"
+
+using namespace std;
+
+const int HAZARD_CHUNK_SIZE = 256;
+const int HAZARD_SLOT_BITS = 16; // handle = slot | generation << HAZARD_SLOT_BITS
+const int HAZARD_SLOT_MASK = (1 << HAZARD_SLOT_BITS) - 1;
+
+class HazardPool {
+private:
+	vector<Hazard *> chunks; // HAZARD_CHUNK_SIZE hazards each
+	vector<int> generation; // per slot
+	vector<int> free_slots;
+	
+	void grow();
+	Hazard *slot(int index);
+
+public:
+	HazardPool();
+	~HazardPool();
+	
+	int alloc();
+	Hazard *get(int handle);
+	void release(int handle);
+	void clear();
+	
+	int live_count;
+};
+
+#endif
@@ -0,0 +1,363 @@
+/**
+ * class ImageLoader
+ *
+ * Converts loaded images to the cheapest display surface that draws them
+ * the same way SDL_DisplayFormatAlpha would.
+ *
+ * @license GPL
+ */
+
+#include "ImageLoader.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Visible colors that fall in one 5-bit per channel histogram cell
+ */
+struct PaletteBin {
+	int key; // r5g5b5
+	int count;
+	double r, g, b; // channel sums
+};
+
+/**
+ * A run of bins that becomes one palette entry
+ */
+struct PaletteBox {
+	int start;
+	int end;
+	int count;
+	int lo[3];
+	int hi[3];
+};
+
+static int binChannel(int key, int channel) {
+	return (key >> (10 - channel*5)) & 31;
+}
+
+struct BinOrder {
+	int channel;
+	bool operator()(const PaletteBin &a, const PaletteBin &b) const {
+		return binChannel(a.key, channel) < binChannel(b.key, channel);
+	}
+};
+
+static PaletteBox makeBox(vector<PaletteBin> &bins, int start, int end) {
+	PaletteBox box;
+	box.start = start;
+	box.end = end;
+	box.count = 0;
+	for (int c=0; c<3; c++) {
+		box.lo[c] = 31;
+		box.hi[c] = 0;
+	}
+	for (int i=start; i<end; i++) {
+		box.count += bins[i].count;
+		for (int c=0; c<3; c++) {
+			int v = binChannel(bins[i].key, c);
+			if (v < box.lo[c]) box.lo[c] = v;
+			if (v > box.hi[c]) box.hi[c] = v;
+		}
+	}
+	return box;
+}
+
+ImageLoader image_loader;
+
+ImageLoader::ImageLoader() {
+	record_count = 0;
+	for (int i=0; i<IMAGE_FORMATS; i++) {
+		format_count[i] = 0;
+		format_pixels[i] = 0;
+	}
+}
+
+/**
+ * Scan the alpha channel of a 32-bit display format alpha surface.
+ * An opaque magenta pixel would vanish under the colorkey, so it keeps alpha.
+ */
+int ImageLoader::classify(SDL_Surface *argb) {
+	SDL_PixelFormat *fmt = argb->format;
+	Uint32 amask = fmt->Amask;
+	Uint32 magenta = SDL_MapRGBA(fmt, 255, 0, 255, 255);
+	bool clear_pixels = false;
+	
+	for (int y=0; y<argb->h; y++) {
+		Uint32 *row = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+		for (int x=0; x<argb->w; x++) {
+			Uint32 a = row[x] & amask;
+			if (a == amask) {
+				if (row[x] == magenta) return IMAGE_ALPHA;
+			}
+			else if (a == 0) {
+				clear_pixels = true;
+			}
+			else {
+				return IMAGE_ALPHA;
+			}
+		}
+	}
+	
+	if (clear_pixels) return IMAGE_COLORKEY;
+	return IMAGE_OPAQUE;
+}
+
+void ImageLoader::record(const string &name, int format, SDL_Surface *surface) {
+	format_count[format]++;
+	format_pixels[format] += surface->w * surface->h;
+	
+	if (record_count == IMAGE_RECORD_MAX) return;
+	records[record_count].name = name;
+	records[record_count].format = format;
+	records[record_count].w = surface->w;
+	records[record_count].h = surface->h;
+	record_count++;
+}
+
+/**
+ * Print the format each image ended up in, then the totals per format
+ */
+void ImageLoader::report() {
+	const char *names[IMAGE_FORMATS] = {"opaque", "colorkey", "alpha", "indexed"};
+	
+	fprintf(stderr, "Images loaded:\n");
+	for (int i=0; i<record_count; i++) {
+		fprintf(stderr, "  %-8s %4dx%-4d %s\n", names[records[i].format], records[i].w, records[i].h, records[i].name.c_str());
+	}
+	fprintf(stderr, "Images by display format:\n");
+	for (int i=0; i<IMAGE_FORMATS; i++) {
+		fprintf(stderr, "  %-8s %5d images %9d pixels\n", names[i], format_count[i], format_pixels[i]);
+	}
+}
+
+/**
+ * Display format alpha copy of raw, freeing raw
+ */
+SDL_Surface *ImageLoader::convert(SDL_Surface *raw, const string &name, bool magenta_key) {
+	if (!raw) return NULL;
+	
+	if (magenta_key) SDL_SetColorKey(raw, SDL_SRCCOLORKEY, SDL_MapRGB(raw->format, 255, 0, 255));
+	
+	SDL_Surface *argb = SDL_DisplayFormatAlpha(raw);
+	SDL_FreeSurface(raw);
+	if (!argb) {
+		fprintf(stderr, "Couldn't convert image %s: %s\n", name.c_str(), SDL_GetError());
+		return NULL;
+	}
+	return argb;
+}
+
+/**
+ * Replace a freshly loaded image with its display surface, freeing raw.
+ * With magenta_key, pure magenta pixels are transparent.
+ * Returns NULL if SDL can't convert the image.
+ */
+SDL_Surface *ImageLoader::optimize(SDL_Surface *raw, const string &name, bool magenta_key) {
+	SDL_Surface *argb = convert(raw, name, magenta_key);
+	if (!argb) return NULL;
+	
+	if (SDL_MUSTLOCK(argb)) SDL_LockSurface(argb);
+	int format = classify(argb);
+	
+	// a 16-bit display format copy would lose the colors the alpha blit keeps
+	SDL_Surface *video = SDL_GetVideoSurface();
+	if (!video || video->format->BytesPerPixel != 4) format = IMAGE_ALPHA;
+	
+	// clear pixels take the key color, so the display format copy can be keyed
+	if (format == IMAGE_COLORKEY) {
+		Uint32 key = SDL_MapRGBA(argb->format, 255, 0, 255, 0);
+		Uint32 amask = argb->format->Amask;
+		for (int y=0; y<argb->h; y++) {
+			Uint32 *row = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+			for (int x=0; x<argb->w; x++) {
+				if ((row[x] & amask) == 0) row[x] = key;
+			}
+		}
+	}
+	if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+	
+	if (format == IMAGE_ALPHA) {
+		record(name, format, argb);
+		return argb;
+	}
+	
+	SDL_SetAlpha(argb, 0, 255);
+	SDL_SetColorKey(argb, 0, 0);
+	SDL_Surface *display = SDL_DisplayFormat(argb);
+	if (!display) {
+		// still drawable, just not the cheap way
+		SDL_SetAlpha(argb, SDL_SRCALPHA, 255);
+		record(name, IMAGE_ALPHA, argb);
+		return argb;
+	}
+	SDL_FreeSurface(argb);
+	
+	// no RLE: an encoded surface must be locked, which sends it back to SDL's blitter
+	if (format == IMAGE_COLORKEY)
+		SDL_SetColorKey(display, SDL_SRCCOLORKEY, SDL_MapRGB(display->format, 255, 0, 255));
+	
+	record(name, format, display);
+	return display;
+}
+
+/**
+ * Replace a freshly loaded image with an 8-bit palette surface, freeing raw.
+ * The palette comes from a median cut of the visible colors; clear pixels
+ * use entry 0 as the colorkey. Images with partial transparency can't be
+ * indexed and keep per-pixel alpha.
+ * Returns NULL if SDL can't convert the image.
+ */
+SDL_Surface *ImageLoader::quantize(SDL_Surface *raw, const string &name) {
+	SDL_Surface *argb = convert(raw, name, false);
+	if (!argb) return NULL;
+	
+	if (SDL_MUSTLOCK(argb)) SDL_LockSurface(argb);
+	int format = classify(argb);
+	if (format == IMAGE_ALPHA) {
+		if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+		record(name, IMAGE_ALPHA, argb);
+		return argb;
+	}
+	
+	SDL_PixelFormat *fmt = argb->format;
+	
+	// histogram of the visible pixels
+	int *bin_of = new int[32768];
+	for (int i=0; i<32768; i++) bin_of[i] = -1;
+	vector<PaletteBin> bins;
+	
+	for (int y=0; y<argb->h; y++) {
+		Uint32 *row = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+		for (int x=0; x<argb->w; x++) {
+			if ((row[x] & fmt->Amask) == 0) continue;
+			int r = (row[x] & fmt->Rmask) >> fmt->Rshift;
+			int g = (row[x] & fmt->Gmask) >> fmt->Gshift;
+			int b = (row[x] & fmt->Bmask) >> fmt->Bshift;
+			int key = ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+			if (bin_of[key] == -1) {
+				PaletteBin bin;
+				bin.key = key;
+				bin.count = 0;
+				bin.r = bin.g = bin.b = 0;
+				bin_of[key] = bins.size();
+				bins.push_back(bin);
+			}
+			PaletteBin *bin = &bins[bin_of[key]];
+			bin->count++;
+			bin->r += r;
+			bin->g += g;
+			bin->b += b;
+		}
+	}
+	
+	// median cut: keep splitting the box with the most pixels over the widest range
+	vector<PaletteBox> boxes;
+	if (!bins.empty()) boxes.push_back(makeBox(bins, 0, bins.size()));
+	
+	while ((int)boxes.size() < IMAGE_PALETTE_SIZE - 1) {
+		int best = -1;
+		int best_channel = 0;
+		double best_score = 0;
+		for (int i=0; i<(int)boxes.size(); i++) {
+			if (boxes[i].end - boxes[i].start < 2) continue;
+			for (int c=0; c<3; c++) {
+				double score = (double)boxes[i].count * (boxes[i].hi[c] - boxes[i].lo[c]);
+				if (score > best_score) {
+					best = i;
+					best_channel = c;
+					best_score = score;
+				}
+			}
+		}
+		if (best == -1) break;
+		
+		PaletteBox box = boxes[best];
+		BinOrder order;
+		order.channel = best_channel;
+		std::sort(bins.begin() + box.start, bins.begin() + box.end, order);
+		
+		int cut = box.start;
+		int half = 0;
+		do {
+			half += bins[cut].count;
+			cut++;
+		} while (cut < box.end - 1 && half < box.count / 2);
+		
+		boxes[best] = makeBox(bins, box.start, cut);
+		boxes.push_back(makeBox(bins, cut, box.end));
+	}
+	
+	SDL_Color colors[IMAGE_PALETTE_SIZE];
+	for (int i=0; i<IMAGE_PALETTE_SIZE; i++) {
+		colors[i].r = colors[i].g = colors[i].b = colors[i].unused = 0;
+	}
+	colors[0].r = 255;
+	colors[0].b = 255;
+	for (int i=0; i<(int)boxes.size(); i++) {
+		double r = 0, g = 0, b = 0;
+		for (int j=boxes[i].start; j<boxes[i].end; j++) {
+			r += bins[j].r;
+			g += bins[j].g;
+			b += bins[j].b;
+		}
+		colors[i+1].r = (Uint8)(r / boxes[i].count + 0.5);
+		colors[i+1].g = (Uint8)(g / boxes[i].count + 0.5);
+		colors[i+1].b = (Uint8)(b / boxes[i].count + 0.5);
+	}
+	
+	// every bin takes the palette entry nearest its own average color
+	for (int i=0; i<(int)bins.size(); i++) {
+		int r = (int)(bins[i].r / bins[i].count + 0.5);
+		int g = (int)(bins[i].g / bins[i].count + 0.5);
+		int b = (int)(bins[i].b / bins[i].count + 0.5);
+		int nearest = 1;
+		int nearest_dist = 0x7fffffff;
+		for (int j=1; j<=(int)boxes.size(); j++) {
+			int dr = r - colors[j].r;
+			int dg = g - colors[j].g;
+			int db = b - colors[j].b;
+			int dist = dr*dr + dg*dg + db*db;
+			if (dist < nearest_dist) {
+				nearest = j;
+				nearest_dist = dist;
+			}
+		}
+		bin_of[bins[i].key] = nearest;
+	}
+	
+	SDL_Surface *indexed = SDL_CreateRGBSurface(SDL_SWSURFACE, argb->w, argb->h, 8, 0, 0, 0, 0);
+	if (!indexed) {
+		fprintf(stderr, "Couldn't create indexed image %s: %s\n", name.c_str(), SDL_GetError());
+		if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+		delete[] bin_of;
+		record(name, IMAGE_ALPHA, argb);
+		return argb;
+	}
+	SDL_SetColors(indexed, colors, 0, IMAGE_PALETTE_SIZE);
+	
+	if (SDL_MUSTLOCK(indexed)) SDL_LockSurface(indexed);
+	for (int y=0; y<argb->h; y++) {
+		Uint32 *row = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+		Uint8 *out = (Uint8 *)indexed->pixels + y * indexed->pitch;
+		for (int x=0; x<argb->w; x++) {
+			if ((row[x] & fmt->Amask) == 0) {
+				out[x] = 0;
+				continue;
+			}
+			int r = (row[x] & fmt->Rmask) >> fmt->Rshift;
+			int g = (row[x] & fmt->Gmask) >> fmt->Gshift;
+			int b = (row[x] & fmt->Bmask) >> fmt->Bshift;
+			out[x] = bin_of[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+		}
+	}
+	if (SDL_MUSTLOCK(indexed)) SDL_UnlockSurface(indexed);
+	if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+	SDL_FreeSurface(argb);
+	delete[] bin_of;
+	
+	if (format == IMAGE_COLORKEY) SDL_SetColorKey(indexed, SDL_SRCCOLORKEY, 0);
+	
+	record(name, IMAGE_INDEXED, indexed);
+	return indexed;
+}
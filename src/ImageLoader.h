@@ -0,0 +1,66 @@
+/**
+ * class ImageLoader
+ *
+ * Converts loaded images to the cheapest display surface that draws them
+ * the same way SDL_DisplayFormatAlpha would:
+ * - fully opaque images become plain display format surfaces
+ * - images with only fully opaque or fully clear pixels become colorkey
+ *   surfaces, left unencoded so the colorkey blit kernel can draw them
+ * - only images with partial transparency keep per-pixel alpha
+ * The first two only draw identically on a 32-bit display; anywhere else
+ * every image keeps per-pixel alpha.
+ * quantize() instead reduces an image to an 8-bit palette, for sprites
+ * where memory matters more than exact color.
+ * Every conversion is recorded in the asset statistics, which report()
+ * prints.
+ *
+ * @license GPL
+ */
+
+#ifndef IMAGE_LOADER_H
+#define IMAGE_LOADER_H
+
+#include <string>
+#include "SDL.h"
+
+using namespace std;
+
+const int IMAGE_OPAQUE = 0;
+const int IMAGE_COLORKEY = 1;
+const int IMAGE_ALPHA = 2;
+const int IMAGE_INDEXED = 3;
+const int IMAGE_FORMATS = 4;
+
+const int IMAGE_PALETTE_SIZE = 256; // entry 0 is the transparent key
+
+const int IMAGE_RECORD_MAX = 512;
+
+struct ImageRecord {
+	string name;
+	int format;
+	int w;
+	int h;
+};
+
+class ImageLoader {
+private:
+	int classify(SDL_Surface *argb);
+	SDL_Surface *convert(SDL_Surface *raw, const string &name, bool magenta_key);
+	void record(const string &name, int format, SDL_Surface *surface);
+
+public:
+	ImageLoader();
+	SDL_Surface *optimize(SDL_Surface *raw, const string &name, bool magenta_key);
+	SDL_Surface *quantize(SDL_Surface *raw, const string &name);
+	void report();
+	
+	// asset statistics
+	ImageRecord records[IMAGE_RECORD_MAX]; // the first IMAGE_RECORD_MAX images
+	int record_count;
+	int format_count[IMAGE_FORMATS]; // images converted to each format
+	int format_pixels[IMAGE_FORMATS]; // and their total area
+};
+
+extern ImageLoader image_loader;
+
+#endif
@@ -13,6 +13,8 @@ ItemDatabase::ItemDatabase(SDL_Surface *_screen, FontEngine *_font) {
 	font = _font;
 	
 	vendor_ratio = 4; // this means scrap/vendor pays 1/4th price to buy items from hero
+	tooltip_cache_count = 0;
+	tooltip_tick = 0;
 	load();
 	loadSounds();
 	loadIcons();
@@ -206,13 +208,9 @@ void ItemDatabase::loadIcons() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = icons32;
-	icons32 = SDL_DisplayFormatAlpha(icons32);
-	SDL_FreeSurface(cleanup);
+	icons32 = image_loader.optimize(icons32, "images/icons/icons32.png", false);
 	
-	cleanup = icons64;
-	icons64 = SDL_DisplayFormatAlpha(icons64);
-	SDL_FreeSurface(cleanup);
+	icons64 = image_loader.optimize(icons64, "images/icons/icons64.png", false);
 }
 
 /**
@@ -220,7 +218,15 @@ void ItemDatabase::loadIcons() {
  * Also display the stack size
  */
 void ItemDatabase::renderIcon(ItemStack stack, int x, int y, int size) {
+	renderIcon(stack, x, y, size, screen);
+}
+
+/**
+ * Render an item icon onto the screen or into a menu panel
+ */
+void ItemDatabase::renderIcon(ItemStack stack, int x, int y, int size, SDL_Surface *target) {
 	stringstream ss;
+	SDL_Surface *icons = NULL;
 	int columns;
 
 	dest.x = x;
@@ -230,30 +236,37 @@ void ItemDatabase::renderIcon(ItemStack stack, int x, int y, int size) {
 		columns = icons32->w / 32;
 		src.x = (items[stack.item].icon32 % columns) * size;
 		src.y = (items[stack.item].icon32 / columns) * size;
-		SDL_BlitSurface(icons32, &src, screen, &dest);
+		icons = icons32;
 	}
 	else if (size == ICON_SIZE_64) {
 		columns = icons64->w / 64;
 		src.x = (items[stack.item].icon64 % columns) * size;
 		src.y = (items[stack.item].icon64 / columns) * size;
-		SDL_BlitSurface(icons64, &src, screen, &dest);
+		icons = icons64;
+	}
+	
+	if (icons) {
+		if (target->format->Amask)
+			blitPanelLayer(icons, &src, target, &dest);
+		else
+			fastBlit(icons, &src, target, &dest);
 	}
 	
 	if( stack.quantity > 1 || items[stack.item].max_quantity > 1) {
 		// stackable item : show the quantity
 		ss << stack.quantity;
-		font->render(ss.str(), dest.x + 2, dest.y + 2, JUSTIFY_LEFT, screen, FONT_WHITE);
+		font->render(ss.str(), dest.x + 2, dest.y + 2, JUSTIFY_LEFT, target, FONT_WHITE);
 	}
 }
 
 void ItemDatabase::playSound(int item) {
 	if (items[item].sfx != SFX_NONE)
 		if (sfx[items[item].sfx])
-			Mix_PlayChannel(-1, sfx[items[item].sfx], 0);
+			sound_queue.play(sfx[items[item].sfx]);
 }
 
 void ItemDatabase::playCoinsSound() {
-	Mix_PlayChannel(-1, sfx[SFX_COINS], 0);
+	sound_queue.play(sfx[SFX_COINS]);
 }
 
 TooltipData ItemDatabase::getShortTooltip( ItemStack stack) {
@@ -285,9 +298,73 @@ TooltipData ItemDatabase::getShortTooltip( ItemStack stack) {
 }
 
 /**
- * Create detailed tooltip showing all relevant item info
+ * The only hero stats a tooltip depends on are whether the item's
+ * requirement is met and, for vendors, whether the hero can afford it
+ */
+int ItemDatabase::tooltipSignature(int item, StatBlock *stats, bool vendor_view) {
+	int signature = 0;
+	
+	if (items[item].req_val > 0) {
+		if (items[item].req_stat == REQUIRES_PHYS && stats->physical < items[item].req_val) signature |= 1;
+		else if (items[item].req_stat == REQUIRES_MENT && stats->mental < items[item].req_val) signature |= 1;
+		else if (items[item].req_stat == REQUIRES_OFF && stats->offense < items[item].req_val) signature |= 1;
+		else if (items[item].req_stat == REQUIRES_DEF && stats->defense < items[item].req_val) signature |= 1;
+	}
+	if (vendor_view && items[item].price > 0 && stats->gold < items[item].price) signature |= 2;
+	
+	return signature;
+}
+
+/**
+ * Detailed tooltip for an item, memoized by (item, vendor_view, stat signature)
+ * so hovering doesn't rebuild the text every frame
  */
 TooltipData ItemDatabase::getTooltip(int item, StatBlock *stats, bool vendor_view) {
+	TooltipCacheEntry *entry;
+
+	if (item == 0) return TooltipData();
+	
+	int signature = tooltipSignature(item, stats, vendor_view);
+	
+	for (int i=0; i<tooltip_cache_count; i++) {
+		entry = &tooltip_cache[i];
+		if (entry->item == item && entry->vendor_view == vendor_view && entry->signature == signature) {
+			entry->last_used = ++tooltip_tick;
+			return entry->tip;
+		}
+	}
+	
+	// not cached; take a free slot or evict the least recently used
+	if (tooltip_cache_count < TOOLTIP_CACHE_SIZE) {
+		entry = &tooltip_cache[tooltip_cache_count++];
+	}
+	else {
+		entry = &tooltip_cache[0];
+		for (int i=1; i<TOOLTIP_CACHE_SIZE; i++) {
+			if (tooltip_cache[i].last_used < entry->last_used) entry = &tooltip_cache[i];
+		}
+	}
+	
+	entry->item = item;
+	entry->vendor_view = vendor_view;
+	entry->signature = signature;
+	entry->last_used = ++tooltip_tick;
+	entry->tip = buildTooltip(item, stats, vendor_view);
+	
+	// lay out once, at the width MenuTooltip wraps to
+	string fulltext = entry->tip.lines[0];
+	for (int i=1; i<entry->tip.num_lines; i++) {
+		fulltext = fulltext + "\n" + entry->tip.lines[i];
+	}
+	entry->tip.size = font->calc_size(fulltext, TOOLTIP_WIDTH);
+	
+	return entry->tip;
+}
+
+/**
+ * Create detailed tooltip showing all relevant item info
+ */
+TooltipData ItemDatabase::buildTooltip(int item, StatBlock *stats, bool vendor_view) {
 	stringstream ss;
 	TooltipData tip;
 	
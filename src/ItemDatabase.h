@@ -18,10 +18,13 @@
 #include "UtilsParsing.h"
 #include "StatBlock.h"
 #include "MenuTooltip.h"
+#include "ImageLoader.h"
+#include "SoundQueue.h"
 
 using namespace std;
 
 const int MAX_ITEM_ID = 10000;
+const int TOOLTIP_CACHE_SIZE = 64;
 
 const int ICON_SIZE_32 = 32;
 const int ICON_SIZE_64 = 64;
@@ -121,6 +124,17 @@ struct ItemStack {
 	bool operator > (ItemStack param);
 };
 
+/**
+ * A built tooltip, valid while the hero stats that color it stay the same
+ */
+struct TooltipCacheEntry {
+	int item;
+	bool vendor_view;
+	int signature;
+	TooltipData tip;
+	int last_used;
+};
+
 class ItemDatabase {
 private:
 	SDL_Surface *screen;
@@ -130,6 +144,13 @@ private:
 	SDL_Rect src;
 	SDL_Rect dest;
 	Mix_Chunk *sfx[12];
+	
+	TooltipCacheEntry tooltip_cache[TOOLTIP_CACHE_SIZE];
+	int tooltip_cache_count;
+	int tooltip_tick;
+	
+	int tooltipSignature(int item, StatBlock *stats, bool vendor_view);
+	TooltipData buildTooltip(int item, StatBlock *stats, bool vendor_view);
 
 public:
 	ItemDatabase(SDL_Surface *_screen, FontEngine *_font);
@@ -138,6 +159,7 @@ public:
 	void loadSounds();
 	void loadIcons();
 	void renderIcon(ItemStack stack, int x, int y, int size);
+	void renderIcon(ItemStack stack, int x, int y, int size, SDL_Surface *target);
 	void playSound(int item);
 	void playCoinsSound();	
 	TooltipData getTooltip(int item, StatBlock *stats, bool vendor_view);
@@ -93,23 +93,13 @@ void LootManager::loadGraphics() {
 	flying_gold[1] = IMG_Load("images/loot/coins25.png");
 	flying_gold[2] = IMG_Load("images/loot/coins100.png");
 	
-	// set magic pink transparency
+	// set magic pink transparency and optimize
 	for (int i=0; i<animation_count; i++) {
-		SDL_SetColorKey( flying_loot[i], SDL_SRCCOLORKEY, SDL_MapRGB(flying_loot[i]->format, 255, 0, 255) ); 
-		
-		// optimize
-		SDL_Surface *cleanup = flying_loot[i];
-		flying_loot[i] = SDL_DisplayFormatAlpha(flying_loot[i]);
-		SDL_FreeSurface(cleanup);
-	}
-	for (int i=0; i<3; i++) {
-		SDL_SetColorKey( flying_gold[i], SDL_SRCCOLORKEY, SDL_MapRGB(flying_gold[i]->format, 255, 0, 255) ); 
-		
-		// optimize
-		SDL_Surface *cleanup = flying_gold[i];
-		flying_gold[i] = SDL_DisplayFormatAlpha(flying_gold[i]);
-		SDL_FreeSurface(cleanup);
+		flying_loot[i] = image_loader.optimize(flying_loot[i], "images/loot/" + animation_id[i] + ".png", true);
 	}
+	flying_gold[0] = image_loader.optimize(flying_gold[0], "images/loot/coins5.png", true);
+	flying_gold[1] = image_loader.optimize(flying_gold[1], "images/loot/coins25.png", true);
+	flying_gold[2] = image_loader.optimize(flying_gold[2], "images/loot/coins100.png", true);
 }
 
 /**
@@ -202,7 +192,6 @@ void LootManager::renderTooltips(Point cam) {
 	
 	Point dest;
 	TooltipData td;
-	stringstream ss;
 	
 	int max_frame = anim_loot_frames * anim_loot_duration - 1;
 	
@@ -219,9 +208,7 @@ void LootManager::renderTooltips(Point cam) {
 			else {
 				td.num_lines = 1;
 				td.colors[0] = FONT_WHITE;
-				ss << loot[i].gold << " Gold";
-				td.lines[0] = ss.str();
-				ss.str("");
+				td.lines[0] = frame_arena.format("%d Gold", loot[i].gold);
 			}
 			
 			tip->render(td, dest, STYLE_TOPLABEL);
@@ -357,7 +344,7 @@ void LootManager::addLoot(ItemStack stack, Point pos) {
 	loot[loot_count].frame = 0;
 	loot[loot_count].gold = 0;
 	loot_count++;
-	if (loot_flip) Mix_PlayChannel(-1, loot_flip, 0);
+	if (loot_flip) sound_queue.play(loot_flip);
 }
 
 void LootManager::addGold(int count, Point pos) {
@@ -368,7 +355,7 @@ void LootManager::addGold(int count, Point pos) {
 	loot[loot_count].frame = 0;
 	loot[loot_count].gold = count;
 	loot_count++;
-	if (loot_flip) Mix_PlayChannel(-1, loot_flip, 0);	
+	if (loot_flip) sound_queue.play(loot_flip);	
 }
 
 
@@ -454,6 +441,7 @@ Renderable LootManager::getRender(int index) {
 	r.offset.x = 32;
 	r.offset.y = 112;
 	r.object_layer = true;
+	r.flip = false;
 
 	if (loot[index].stack.item > 0) {
 		// item
@@ -17,9 +17,12 @@
 #include "SDL_mixer.h"
 
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "ItemDatabase.h"
 #include "MenuTooltip.h"
 #include "EnemyManager.h"
+#include "FrameArena.h"
+#include "SoundQueue.h"
 
 struct LootDef {
 	ItemStack stack;
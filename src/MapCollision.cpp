@@ -15,6 +15,15 @@
 using namespace std;
 
 MapCollision::MapCollision() {
+	for (int i=0; i<256; i++) {
+		for (int j=0; j<256; j++) {
+			vis_stamp[i][j] = 0;
+		}
+	}
+	vis_generation = 0;
+	vis_tile.x = vis_tile.y = -1;
+	vis_pos.x = vis_pos.y = -1;
+	vis_dirty = true;
 }
 
 void MapCollision::setmap(unsigned short _colmap[256][256]) {
@@ -25,32 +34,54 @@ void MapCollision::setmap(unsigned short _colmap[256][256]) {
 	}
 	map_size.x = 0;
 	map_size.y = 0;
+	vis_dirty = true;
+}
+
+/**
+ * How many unit steps along one axis, starting at pos, keep both pos and pos+step
+ * inside the same tiles they are in now. Collision answers can't change before then.
+ */
+int MapCollision::steps_in_tile(int pos, int step) {
+	int r = pos - ((pos >> TILE_SHIFT) << TILE_SHIFT);
+	if (step > 0) return (r < UNITS_PER_TILE-1) ? UNITS_PER_TILE-1 - r : 1;
+	if (step < 0) return (r > 0) ? r : 1;
+	return UNITS_PER_TILE; // not moving on this axis
 }
 
 /**
  * Process movement for cardinal (90 degree) and ordinal (45 degree) directions
  * If we encounter an obstacle at 90 degrees, stop.
  * If we encounter an obstacle at 45 or 135 degrees, slide.
+ *
+ * Collision only changes at tile edges, so each decision is applied to
+ * the whole run of units up to the next edge instead of unit by unit.
  */
 bool MapCollision::move(int &x, int &y, int step_x, int step_y, int dist) {
 
 	bool diag = false;
 	if (step_x != 0 && step_y != 0) diag = true;
 	
-	for (int i=0; i<dist; i++) {
+	int run;
+	
+	while (dist > 0) {
 		if (is_empty(x + step_x, y + step_y)) {
-			x+= step_x;
-			y+= step_y;
+			run = min(steps_in_tile(x, step_x), steps_in_tile(y, step_y));
+			run = min(run, dist);
+			x += step_x * run;
+			y += step_y * run;
 		}
 		else if (diag && is_empty(x + step_x, y)) { // slide along wall
-			x+= step_x;
+			run = min(steps_in_tile(x, step_x), dist);
+			x += step_x * run;
 		}
 		else if (diag && is_empty(x, y + step_y)) { // slide along wall
-			y+= step_y;
+			run = min(steps_in_tile(y, step_y), dist);
+			y += step_y * run;
 		}
 		else { // absolute stop
 			return false;
 		}
+		dist -= run;
 	}
 	return true;
 }
@@ -84,59 +115,87 @@ bool MapCollision::is_wall(int x, int y) {
 	return false;
 }
 
+/**
+ * Is this tile an obstacle for the given check type?
+ */
+bool MapCollision::tile_blocks(int tile_x, int tile_y, int checktype) {
+	if (outsideMap(tile_x, tile_y)) return true;
+	
+	if (checktype == CHECK_SIGHT)
+		return colmap[tile_x][tile_y] == BLOCKS_ALL || colmap[tile_x][tile_y] == BLOCKS_ALL_HIDDEN;
+	return colmap[tile_x][tile_y] != 0;
+}
+
 /**
  * Does not have the "slide" submovement that move() features
  * Line can be arbitrary angles.
+ *
+ * Walks the tiles the line crosses (Amanatides-Woo grid traversal),
+ * visiting each one once. On a hit, result_x,result_y is the last point
+ * of the line before the blocking tile; otherwise it is x2,y2.
  */
 bool MapCollision::line_check(int x1, int y1, int x2, int y2, int checktype) {
-	float x = (float)x1;
-	float y = (float)y1;
-	float dx = (float)abs(x2 - x1);
-	float dy = (float)abs(y2 - y1);
-	float step_x;
-	float step_y;
-	int steps = (int)max(dx, dy);
-
-
-	if (dx > dy) {
-		step_x = 1;
-		step_y = dy / dx;
+	int dx = x2 - x1;
+	int dy = y2 - y1;
+	int steps = max(abs(dx), abs(dy));
+	
+	result_x = x2;
+	result_y = y2;
+	if (steps == 0) return true;
+	
+	int tile_x = x1 >> TILE_SHIFT;
+	int tile_y = y1 >> TILE_SHIFT;
+	int end_x = x2 >> TILE_SHIFT;
+	int end_y = y2 >> TILE_SHIFT;
+	int step_x = (dx > 0) - (dx < 0);
+	int step_y = (dy > 0) - (dy < 0);
+	
+	// line parameter t (0 at x1,y1 and 1 at x2,y2) of the next tile edge on each axis
+	float t_max_x = 2.0;
+	float t_max_y = 2.0;
+	float t_delta_x = 0.0;
+	float t_delta_y = 0.0;
+	if (dx != 0) {
+		int edge = (step_x > 0) ? (tile_x + 1) << TILE_SHIFT : tile_x << TILE_SHIFT;
+		t_max_x = (float)(edge - x1) / dx;
+		t_delta_x = (float)UNITS_PER_TILE / abs(dx);
 	}
-	else {
-		step_y = 1;
-		step_x = dx / dy;
+	if (dy != 0) {
+		int edge = (step_y > 0) ? (tile_y + 1) << TILE_SHIFT : tile_y << TILE_SHIFT;
+		t_max_y = (float)(edge - y1) / dy;
+		t_delta_y = (float)UNITS_PER_TILE / abs(dy);
 	}
-	// fix signs
-	if (x1 > x2) step_x = -step_x;
-	if (y1 > y2) step_y = -step_y;
-
-	
-	if (checktype == CHECK_SIGHT) {
-		for (int i=0; i<steps; i++) {
-			x += step_x;
-			y += step_y;
-			if (is_wall(round(x), round(y))) {
-				result_x = round(x -= step_x);
-				result_y = round(y -= step_y);
-				return false;
-			}
+	
+	float t = 0.0;
+	int remaining = abs(end_x - tile_x) + abs(end_y - tile_y);
+	
+	while (!tile_blocks(tile_x, tile_y, checktype)) {
+		if (remaining-- == 0) return true;
+		
+		if (t_max_x < t_max_y) {
+			tile_x += step_x;
+			t = t_max_x;
+			t_max_x += t_delta_x;
 		}
-	}
-	else if (checktype == CHECK_MOVEMENT) {
-		for (int i=0; i<steps; i++) {
-			x += step_x;
-			y += step_y;
-			if (!is_empty(round(x), round(y))) {
-				result_x = round(x -= step_x);
-				result_y = round(y -= step_y);
-				return false;
-			}
+		else {
+			tile_y += step_y;
+			t = t_max_y;
+			t_max_y += t_delta_y;
 		}
 	}
 	
-	result_x = x2;
-	result_y = y2;
-	return true;
+	result_tile.x = tile_x;
+	result_tile.y = tile_y;
+	
+	// back up to the last whole step along the line that is still outside the obstacle
+	int i = (int)ceil(t * steps) - 1;
+	if (i < 0) i = 0;
+	do {
+		result_x = round(x1 + (float)dx * i / steps);
+		result_y = round(y1 + (float)dy * i / steps);
+	} while (i-- > 0 && tile_blocks(result_x >> TILE_SHIFT, result_y >> TILE_SHIFT, checktype));
+	
+	return false;
 }
 
 bool MapCollision::line_of_sight(int x1, int y1, int x2, int y2) {
@@ -147,6 +206,112 @@ bool MapCollision::line_of_movement(int x1, int y1, int x2, int y2) {
 
 }
 
+/**
+ * Recompute the visibility field if the origin moved to another tile
+ * or the collision map changed. Called once per frame with the hero position,
+ * so enemies can check sight with one lookup instead of tracing a ray each.
+ */
+void MapCollision::update_visibility(int x, int y) {
+	int tile_x = x >> TILE_SHIFT;
+	int tile_y = y >> TILE_SHIFT;
+	
+	vis_pos.x = x;
+	vis_pos.y = y;
+	
+	if (!vis_dirty && tile_x == vis_tile.x && tile_y == vis_tile.y) return;
+	
+	vis_tile.x = tile_x;
+	vis_tile.y = tile_y;
+	vis_dirty = false;
+	
+	// a new generation invalidates every stamp at once
+	vis_generation++;
+	
+	if (outsideMap(tile_x, tile_y)) return;
+	vis_stamp[tile_x][tile_y] = vis_generation;
+	
+	// recursive shadowcasting, one call per octant
+	static const int mult[4][8] = {
+		{1,  0,  0, -1, -1,  0,  0,  1},
+		{0,  1, -1,  0,  0, -1,  1,  0},
+		{0,  1,  1,  0,  0, -1, -1,  0},
+		{1,  0,  0,  1, -1,  0,  0, -1}
+	};
+	for (int oct=0; oct<8; oct++) {
+		cast_light(1, 1.0, 0.0, mult[0][oct], mult[1][oct], mult[2][oct], mult[3][oct]);
+	}
+}
+
+/**
+ * Light one octant, row by row outward from the origin tile.
+ * start and end are the slopes still visible; a wall splits the
+ * remaining arc and the part before it continues in a recursive call.
+ */
+void MapCollision::cast_light(int row, float start, float end, int xx, int xy, int yx, int yy) {
+	if (start < end) return;
+	
+	float new_start = 0.0;
+	bool blocked = false;
+	int dx, dy;
+	int tile_x, tile_y;
+	float l_slope, r_slope;
+	bool wall;
+	
+	for (int j=row; j<=VISIBILITY_RADIUS && !blocked; j++) {
+		dy = -j;
+		for (dx = -j; dx <= 0; dx++) {
+			tile_x = vis_tile.x + dx * xx + dy * xy;
+			tile_y = vis_tile.y + dx * yx + dy * yy;
+			l_slope = (dx - 0.5) / (dy + 0.5);
+			r_slope = (dx + 0.5) / (dy - 0.5);
+			
+			if (start < r_slope) continue;
+			if (end > l_slope) break;
+			
+			wall = outsideMap(tile_x, tile_y) || colmap[tile_x][tile_y] == BLOCKS_ALL || colmap[tile_x][tile_y] == BLOCKS_ALL_HIDDEN;
+			if (!outsideMap(tile_x, tile_y) && dx*dx + dy*dy <= VISIBILITY_RADIUS * VISIBILITY_RADIUS)
+				vis_stamp[tile_x][tile_y] = vis_generation;
+			
+			if (blocked) {
+				if (wall) {
+					new_start = r_slope;
+				}
+				else {
+					blocked = false;
+					start = new_start;
+				}
+			}
+			else if (wall && j < VISIBILITY_RADIUS) {
+				blocked = true;
+				cast_light(j+1, start, l_slope, xx, xy, yx, yy);
+				new_start = r_slope;
+			}
+		}
+	}
+}
+
+/**
+ * Collision changed (e.g. a mapmod opened a door); recompute on the next update
+ */
+void MapCollision::invalidate_visibility() {
+	vis_dirty = true;
+}
+
+/**
+ * Can the visibility origin be seen from this position?
+ * Positions beyond the field radius fall back to tracing a ray.
+ */
+bool MapCollision::is_visible(int x, int y) {
+	int tile_x = x >> TILE_SHIFT;
+	int tile_y = y >> TILE_SHIFT;
+	int dx = tile_x - vis_tile.x;
+	int dy = tile_y - vis_tile.y;
+	
+	if (vis_dirty || outsideMap(tile_x, tile_y) || dx*dx + dy*dy > VISIBILITY_RADIUS * VISIBILITY_RADIUS)
+		return line_of_sight(x, y, vis_pos.x, vis_pos.y);
+	
+	return vis_stamp[tile_x][tile_y] == vis_generation;
+}
 
 // TODO: A*
 
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <stdlib.h>
+#include <math.h>
 #include "Utils.h"
 #include "Settings.h"
 
@@ -27,10 +28,23 @@ const int BLOCKS_MOVEMENT_HIDDEN = 4;
 const int CHECK_MOVEMENT = 1;
 const int CHECK_SIGHT = 2;
 
+// visibility field radius, in tiles (covers every enemy threat_range)
+const int VISIBILITY_RADIUS = 16;
+
 class MapCollision {
 private:
 
 	bool line_check(int x1, int y1, int x2, int y2, int checktype);
+	bool tile_blocks(int tile_x, int tile_y, int checktype);
+	int steps_in_tile(int pos, int step);
+	void cast_light(int row, float start, float end, int xx, int xy, int yx, int yy);
+	
+	// tiles seen from the visibility origin carry the current generation
+	int vis_stamp[256][256];
+	int vis_generation;
+	Point vis_tile;
+	Point vis_pos;
+	bool vis_dirty;
 	
 public:
 	MapCollision();
@@ -43,12 +57,17 @@ public:
 
 	bool line_of_sight(int x1, int y1, int x2, int y2);
 	bool line_of_movement(int x1, int y1, int x2, int y2);
+	
+	void update_visibility(int x, int y);
+	void invalidate_visibility();
+	bool is_visible(int x, int y);
 
 	unsigned short colmap[256][256];
 	Point map_size;
 		
 	int result_x;
 	int result_y;
+	Point result_tile; // the tile that stopped the last blocked line check
 };
 
 #endif
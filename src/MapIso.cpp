@@ -9,10 +9,11 @@
  
 #include "MapIso.h"
 
-MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp) {
+MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp, TaskScheduler *_tasks) {
 
 	screen = _screen;
 	camp = _camp;
+	blits = new BlitQueue(_screen, _tasks);
 
 	// cam(x,y) is where on the map the camera is pointing
 	// units found in Settings.h (UNITS_PER_TILE)
@@ -20,6 +21,7 @@ MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp) {
 	cam.y = 0;
 	
 	new_music = false;
+	pathfinder.setCollision(&collider);
 
 	clearEvents();
 	enemy_awaiting_queue = false;
@@ -32,6 +34,7 @@ MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp) {
 	music = NULL;
 	log_msg = "";
 	shaky_cam_ticks = 0;
+	shaky_cam_pending = 0;
 	
 	// spawn is a special map that defines where the campaign begins
 	// load("spawn.txt");
@@ -332,9 +335,11 @@ int MapIso::load(string filename) {
 
 	infile.close();
 
+	while (!collision_mods.empty()) collision_mods.pop();
 	collider.setmap(collision);
 	collider.map_size.x = w;
 	collider.map_size.y = h;
+	pathfinder.invalidate();
 	
 	if (this->new_music) {
 		loadMusic();
@@ -364,10 +369,14 @@ void MapIso::loadMusic() {
 }
 
 void MapIso::logic() {
+	if (shaky_cam_pending > 0) {
+		shaky_cam_ticks = shaky_cam_pending;
+		shaky_cam_pending = 0;
+	}
 	if (shaky_cam_ticks > 0) shaky_cam_ticks--;
 }
 
-void MapIso::render(Renderable r[], int rnum) {
+void MapIso::render(Renderable r[], int rnum, Point view) {
 
 	// r will become a list of renderables.  Everything not on the map already:
 	// - hero
@@ -389,16 +398,16 @@ void MapIso::render(Renderable r[], int rnum) {
 	Point ycam;
 	
 	if (shaky_cam_ticks == 0) {
-		xcam.x = cam.x/UNITS_PER_PIXEL_X;
-		xcam.y = cam.y/UNITS_PER_PIXEL_X;
-		ycam.x = cam.x/UNITS_PER_PIXEL_Y;
-		ycam.y = cam.y/UNITS_PER_PIXEL_Y;
+		xcam.x = view.x/UNITS_PER_PIXEL_X;
+		xcam.y = view.y/UNITS_PER_PIXEL_X;
+		ycam.x = view.x/UNITS_PER_PIXEL_Y;
+		ycam.y = view.y/UNITS_PER_PIXEL_Y;
 	}
 	else {
-		xcam.x = (cam.x + rand() % 16 - 8) /UNITS_PER_PIXEL_X;
-		xcam.y = (cam.y + rand() % 16 - 8) /UNITS_PER_PIXEL_X;
-		ycam.x = (cam.x + rand() % 16 - 8) /UNITS_PER_PIXEL_Y;
-		ycam.y = (cam.y + rand() % 16 - 8) /UNITS_PER_PIXEL_Y;
+		xcam.x = (view.x + rand() % 16 - 8) /UNITS_PER_PIXEL_X;
+		xcam.y = (view.y + rand() % 16 - 8) /UNITS_PER_PIXEL_X;
+		ycam.x = (view.x + rand() % 16 - 8) /UNITS_PER_PIXEL_Y;
+		ycam.y = (view.y + rand() % 16 - 8) /UNITS_PER_PIXEL_Y;
 	}
 	
 	// todo: trim by screen rect
@@ -418,7 +427,7 @@ void MapIso::render(Renderable r[], int rnum) {
 				dest.w = tset.tiles[current_tile].src.w;
 				dest.h = tset.tiles[current_tile].src.h;
 				
-				SDL_BlitSurface(tset.sprites, &(tset.tiles[current_tile].src), screen, &dest);
+				blits->blit(tset.sprites, &(tset.tiles[current_tile].src), &dest, false);
 	
 			}
 		}
@@ -434,7 +443,7 @@ void MapIso::render(Renderable r[], int rnum) {
 			dest.x = VIEW_W_HALF + (r[ri].map_pos.x/UNITS_PER_PIXEL_X - xcam.x) - (r[ri].map_pos.y/UNITS_PER_PIXEL_X - xcam.y) - r[ri].offset.x;
 			dest.y = VIEW_H_HALF + (r[ri].map_pos.x/UNITS_PER_PIXEL_Y - ycam.x) + (r[ri].map_pos.y/UNITS_PER_PIXEL_Y - ycam.y) - r[ri].offset.y;
 
-			SDL_BlitSurface(r[ri].sprite, &r[ri].src, screen, &dest);
+			blits->blit(r[ri].sprite, &r[ri].src, &dest, r[ri].flip);
 		} 
 	}
 		
@@ -457,7 +466,7 @@ void MapIso::render(Renderable r[], int rnum) {
 				dest.w = tset.tiles[current_tile].src.w;
 				dest.h = tset.tiles[current_tile].src.h;
 				
-				SDL_BlitSurface(tset.sprites, &(tset.tiles[current_tile].src), screen, &dest);
+				blits->blit(tset.sprites, &(tset.tiles[current_tile].src), &dest, false);
 	
 			}
 			
@@ -470,7 +479,7 @@ void MapIso::render(Renderable r[], int rnum) {
 					dest.x = VIEW_W_HALF + (r[r_cursor].map_pos.x/UNITS_PER_PIXEL_X - xcam.x) - (r[r_cursor].map_pos.y/UNITS_PER_PIXEL_X - xcam.y) - r[r_cursor].offset.x;
 					dest.y = VIEW_H_HALF + (r[r_cursor].map_pos.x/UNITS_PER_PIXEL_Y - ycam.x) + (r[r_cursor].map_pos.y/UNITS_PER_PIXEL_Y - ycam.y) - r[r_cursor].offset.y;
 
-					SDL_BlitSurface(r[r_cursor].sprite, &r[r_cursor].src, screen, &dest);				
+					blits->blit(r[r_cursor].sprite, &r[r_cursor].src, &dest, r[r_cursor].flip);				
 				}
 				
 				r_cursor++;
@@ -478,6 +487,8 @@ void MapIso::render(Renderable r[], int rnum) {
 			}
 		}
 	}
+	
+	blits->flush();
 }
 
 void MapIso::checkEvents(Point loc) {
@@ -530,6 +541,10 @@ void MapIso::executeEvent(int eid) {
 			if (ec->s == "collision") {
 				collision[ec->x][ec->y] = ec->z;
 				collider.colmap[ec->x][ec->y] = ec->z;
+				Point mod;
+				mod.x = ec->x;
+				mod.y = ec->y;
+				collision_mods.push(mod);
 			}
 			else if (ec->s == "object") {
 				object[ec->x][ec->y] = ec->z;			
@@ -568,5 +583,6 @@ MapIso::~MapIso() {
 		Mix_FreeMusic(music);
 	}
 	if (sfx) Mix_FreeChunk(sfx);
+	delete blits;
 }
 
@@ -19,9 +19,11 @@
 #include "Utils.h"
 #include "TileSet.h"
 #include "MapCollision.h"
+#include "MapPathfinder.h"
 #include "Settings.h"
 #include "UtilsParsing.h"
 #include "CampaignManager.h"
+#include "BlitQueue.h"
 
 using namespace std;
 
@@ -48,6 +50,7 @@ struct Map_Event {
 class MapIso {
 private:
 	SDL_Surface *screen;
+	BlitQueue *blits; // the map and renderables draw through this
 
 	Mix_Music *music;
 		
@@ -68,7 +71,7 @@ public:
 	CampaignManager *camp;
 
 	// functions
-	MapIso(SDL_Surface *_screen, CampaignManager *_camp);
+	MapIso(SDL_Surface *_screen, CampaignManager *_camp, TaskScheduler *_tasks);
 	~MapIso();
 	void clearEnemy(Map_Enemy e);
 	void clearNPC(Map_NPC n);
@@ -76,7 +79,7 @@ public:
 	int load(string filename);
 	void loadMusic();
 	void logic();
-	void render(Renderable r[], int rnum);
+	void render(Renderable r[], int rnum, Point view);
 	void checkEvents(Point loc);
 	void clearEvents();
 
@@ -97,6 +100,7 @@ public:
 	unsigned short object[256][256];
 	unsigned short collision[256][256];
 	MapCollision collider;
+	MapPathfinder pathfinder;
 
 	// enemy load handling
 	queue<Map_Enemy> enemies;
@@ -110,6 +114,9 @@ public:
 	
 	// event-created loot or items
 	queue<Event_Component> loot;
+	
+	// tiles whose collision was changed by a mapmod event
+	queue<Point> collision_mods;
 
 	// teleport handling
 	bool teleportation;
@@ -123,6 +130,7 @@ public:
 	
 	// shaky cam
 	int shaky_cam_ticks;
+	int shaky_cam_pending; // requested by the world tick, started by logic()
 	
 };
 
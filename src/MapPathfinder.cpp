@@ -0,0 +1,382 @@
+/**
+ * class MapPathfinder
+ *
+ * A* search over the collision grid, shared by everything that walks.
+ * Searches run under a per-frame node budget and resume on later frames;
+ * finished paths are cached until the collision map changes.
+ * A flow field toward the hero serves every enemy chasing the hero at once.
+ *
+ * @license GPL
+ */
+
+#include "MapPathfinder.h"
+
+MapPathfinder::MapPathfinder() {
+	collider = NULL;
+	for (int i=0; i<256*256; i++) {
+		visited[i] = 0;
+		closed[i] = 0;
+		flow_stamp[i] = 0;
+	}
+	for (int i=0; i<PATH_CACHE_SIZE; i++) {
+		cache[i].generation = -1;
+	}
+	search_id = 0;
+	search_active = false;
+	search_nodes = 0;
+	open_count = 0;
+	request_head = 0;
+	request_count = 0;
+	cache_generation = 0;
+	budget = PATH_NODE_BUDGET;
+	nodes_expanded = 0;
+	cache_hits = 0;
+	flow_generation = 0;
+	flow_origin = -1;
+	flow_limit = 0;
+	flow_dirty = true;
+	flow_open_count = 0;
+	flow_builds = 0;
+}
+
+void MapPathfinder::setCollision(MapCollision *_collider) {
+	collider = _collider;
+	invalidate();
+}
+
+/**
+ * The collision map changed (new map or a mapmod).
+ * Drop every cached path and every search in progress.
+ */
+void MapPathfinder::invalidate() {
+	cache_generation++;
+	request_count = 0;
+	search_active = false;
+	flow_dirty = true;
+}
+
+/**
+ * Start a new frame's node budget and continue any queued searches
+ */
+void MapPathfinder::logic() {
+	budget = PATH_NODE_BUDGET;
+	process();
+}
+
+/**
+ * Direction for something at "from" walking to "to", both in map units.
+ * On PATH_FOUND, waypoint is the center of the next tile on the path.
+ * PATH_PENDING means the search is queued and will resume next frame.
+ */
+int MapPathfinder::findPath(Point from, Point to, Point &waypoint) {
+	int start_x = from.x >> TILE_SHIFT;
+	int start_y = from.y >> TILE_SHIFT;
+	int goal_x = to.x >> TILE_SHIFT;
+	int goal_y = to.y >> TILE_SHIFT;
+
+	if (start_x == goal_x && start_y == goal_y) {
+		waypoint = to;
+		return PATH_FOUND;
+	}
+	if (!walkable(goal_x, goal_y) || collider->outsideMap(start_x, start_y)) return PATH_NONE;
+
+	int start = start_x + (start_y << 8);
+	int goal = goal_x + (goal_y << 8);
+
+	// queue a search unless one is cached or already waiting
+	PathCacheEntry *entry = cacheSlot(start, goal);
+	if (entry->generation != cache_generation || entry->start != start || entry->goal != goal) {
+		bool queued = false;
+		for (int i=0; i<request_count; i++) {
+			PathRequest *req = &requests[(request_head + i) % PATH_MAX_REQUESTS];
+			if (req->start == start && req->goal == goal) queued = true;
+		}
+		if (!queued) {
+			if (request_count == PATH_MAX_REQUESTS) return PATH_PENDING;
+			PathRequest *req = &requests[(request_head + request_count) % PATH_MAX_REQUESTS];
+			req->start = start;
+			req->goal = goal;
+			request_count++;
+		}
+
+		// cheap searches finish within this frame's leftover budget
+		process();
+		entry = cacheSlot(start, goal);
+		if (entry->generation != cache_generation || entry->start != start || entry->goal != goal)
+			return PATH_PENDING;
+	}
+	else {
+		cache_hits++;
+	}
+
+	if (entry->next == -1) return PATH_NONE;
+
+	waypoint.x = ((entry->next & 255) << TILE_SHIFT) + UNITS_PER_TILE/2;
+	waypoint.y = ((entry->next >> 8) << TILE_SHIFT) + UNITS_PER_TILE/2;
+	return PATH_FOUND;
+}
+
+bool MapPathfinder::walkable(int x, int y) {
+	if (collider->outsideMap(x, y)) return false;
+	return collider->colmap[x][y] == 0;
+}
+
+/**
+ * Can something on tile (x,y) step onto (x+dx,y+dy)?
+ * A diagonal step needs one open side to slide along.
+ */
+bool MapPathfinder::canStep(int x, int y, int dx, int dy) {
+	if (!walkable(x+dx, y+dy)) return false;
+	if (dx != 0 && dy != 0 && !walkable(x+dx, y) && !walkable(x, y+dy)) return false;
+	return true;
+}
+
+/**
+ * Octile distance, consistent with the step costs
+ */
+int MapPathfinder::heuristic(int tile, int goal) {
+	int dx = abs((tile & 255) - (goal & 255));
+	int dy = abs((tile >> 8) - (goal >> 8));
+	if (dx > dy) return PATH_COST_STRAIGHT * (dx - dy) + PATH_COST_DIAGONAL * dy;
+	return PATH_COST_STRAIGHT * (dy - dx) + PATH_COST_DIAGONAL * dx;
+}
+
+/**
+ * Binary heap insert on an open list pool
+ */
+void MapPathfinder::openPush(PathOpenNode *heap, int &count, int tile, int f) {
+	int i = count++;
+	while (i > 0) {
+		int up = (i-1) / 2;
+		if (heap[up].f <= f) break;
+		heap[i] = heap[up];
+		i = up;
+	}
+	heap[i].tile = tile;
+	heap[i].f = f;
+}
+
+/**
+ * Remove and return the open tile with the lowest f
+ */
+int MapPathfinder::openPop(PathOpenNode *heap, int &count) {
+	int tile = heap[0].tile;
+	PathOpenNode last = heap[--count];
+	int i = 0;
+	while (true) {
+		int child = i+i+1;
+		if (child >= count) break;
+		if (child+1 < count && heap[child+1].f < heap[child].f) child++;
+		if (last.f <= heap[child].f) break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+	return tile;
+}
+
+PathCacheEntry *MapPathfinder::cacheSlot(int start, int goal) {
+	return &cache[(start * 31 + goal * 17) & (PATH_CACHE_SIZE-1)];
+}
+
+void MapPathfinder::cacheStore(int start, int goal, int next) {
+	PathCacheEntry *entry = cacheSlot(start, goal);
+	entry->start = start;
+	entry->goal = goal;
+	entry->next = next;
+	entry->generation = cache_generation;
+}
+
+void MapPathfinder::finishRequest() {
+	request_head = (request_head + 1) % PATH_MAX_REQUESTS;
+	request_count--;
+	search_active = false;
+}
+
+/**
+ * Expand nodes for the queued requests, oldest first, until the budget runs out
+ */
+void MapPathfinder::process() {
+	static const int step_x[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+	static const int step_y[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+	while (budget > 0 && request_count > 0) {
+		PathRequest *req = &requests[request_head];
+
+		if (!search_active) {
+			search_id++;
+			search_active = true;
+			search_nodes = 0;
+			open_count = 0;
+			g[req->start] = 0;
+			parent[req->start] = -1;
+			visited[req->start] = search_id;
+			openPush(open, open_count, req->start, heuristic(req->start, req->goal));
+		}
+
+		if (open_count == 0 || search_nodes >= PATH_MAX_NODES) {
+			cacheStore(req->start, req->goal, -1);
+			finishRequest();
+			continue;
+		}
+
+		int tile = openPop(open, open_count);
+		if (closed[tile] == search_id) continue; // stale duplicate entry
+		closed[tile] = search_id;
+		budget--;
+		search_nodes++;
+		nodes_expanded++;
+
+		if (tile == req->goal) {
+			// every tile on the path learns its next step toward this goal
+			int next = tile;
+			for (int t = parent[tile]; t != -1; t = parent[t]) {
+				cacheStore(t, req->goal, next);
+				next = t;
+			}
+			finishRequest();
+			continue;
+		}
+
+		int x = tile & 255;
+		int y = tile >> 8;
+		for (int i=0; i<8; i++) {
+			int nx = x + step_x[i];
+			int ny = y + step_y[i];
+			if (!canStep(x, y, step_x[i], step_y[i])) continue;
+
+			int cost = PATH_COST_STRAIGHT;
+			if (step_x[i] != 0 && step_y[i] != 0) cost = PATH_COST_DIAGONAL;
+
+			int n = nx + (ny << 8);
+			if (closed[n] == search_id) continue;
+			if (visited[n] == search_id && g[n] <= g[tile] + cost) continue;
+			if (open_count == PATH_OPEN_POOL) continue;
+
+			visited[n] = search_id;
+			g[n] = g[tile] + cost;
+			parent[n] = tile;
+			openPush(open, open_count, n, g[n] + heuristic(n, req->goal));
+		}
+	}
+}
+
+/**
+ * Keep the flow field centered on the hero.
+ * reach is how far (map units) any enemy may chase the hero; the field is
+ * only rebuilt when the hero enters a new tile, the reach grows, or the
+ * collision map changes.
+ */
+void MapPathfinder::updateFlowField(Point hero_pos, int reach) {
+	if (reach <= 0) return; // nobody is close enough to give chase
+	int x = hero_pos.x >> TILE_SHIFT;
+	int y = hero_pos.y >> TILE_SHIFT;
+	int origin = -1;
+	if (!collider->outsideMap(x, y)) origin = x + (y << 8);
+
+	// path distance is at least straight-line distance, so this bounds the search
+	int limit = (reach / UNITS_PER_TILE + 2) * PATH_COST_STRAIGHT;
+
+	if (!flow_dirty && origin == flow_origin && limit <= flow_limit) return;
+	flow_origin = origin;
+	flow_limit = limit;
+	flow_dirty = false;
+	buildFlowField();
+}
+
+/**
+ * Dijkstra outward from the hero tile, clipped at flow_limit.
+ * Every build starts over, because a new origin changes every distance.
+ * A path is never shorter than its tile count, so the field stays inside
+ * a square of flow_limit / PATH_COST_STRAIGHT tiles each way. At the
+ * longest shipped chase reach (1280 units) that is 22 tiles each way,
+ * 45x45 = 2025 tiles. Each tile is pushed at most once per neighbour, so
+ * at most 8 * 2025 = 16200 open list entries.
+ * If the open list runs out, no tile is left in the field.
+ */
+void MapPathfinder::buildFlowField() {
+	static const int step_x[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+	static const int step_y[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+	flow_generation++;
+	flow_builds++;
+	flow_open_count = 0;
+	if (flow_origin == -1) return;
+
+	flow_dist[flow_origin] = 0;
+	flow_stamp[flow_origin] = flow_generation;
+	openPush(flow_open, flow_open_count, flow_origin, 0);
+
+	while (flow_open_count > 0) {
+		int d0 = flow_open[0].f;
+		int tile = openPop(flow_open, flow_open_count);
+		if (d0 > flow_dist[tile]) continue; // stale duplicate entry
+		int x = tile & 255;
+		int y = tile >> 8;
+
+		for (int i=0; i<8; i++) {
+			if (!canStep(x, y, step_x[i], step_y[i])) continue;
+
+			int cost = PATH_COST_STRAIGHT;
+			if (step_x[i] != 0 && step_y[i] != 0) cost = PATH_COST_DIAGONAL;
+
+			int n = (x + step_x[i]) + ((y + step_y[i]) << 8);
+			int d = flow_dist[tile] + cost;
+			if (d > flow_limit) continue;
+			if (flow_stamp[n] == flow_generation && flow_dist[n] <= d) continue;
+			if (flow_open_count == FLOW_OPEN_POOL) {
+				// a partial field would leave some chasers without a step and
+				// send others the long way round; drop it so they use findPath()
+				fprintf(stderr, "Flow field open list full at distance %d, chasing with A* instead\n", flow_limit);
+				flow_generation++;
+				flow_open_count = 0;
+				return;
+			}
+
+			flow_stamp[n] = flow_generation;
+			flow_dist[n] = d;
+			openPush(flow_open, flow_open_count, n, d);
+		}
+	}
+}
+
+/**
+ * Direction for something at "from" chasing the hero at "to".
+ * Returns false if "to" is not the flow field's tile or "from" is outside
+ * the field; otherwise waypoint is the center of the next tile downhill.
+ */
+bool MapPathfinder::flowStep(Point from, Point to, Point &waypoint) {
+	static const int step_x[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+	static const int step_y[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+	if (flow_dirty || flow_origin == -1) return false;
+	if ((to.x >> TILE_SHIFT) + ((to.y >> TILE_SHIFT) << 8) != flow_origin) return false;
+
+	int x = from.x >> TILE_SHIFT;
+	int y = from.y >> TILE_SHIFT;
+	if (collider->outsideMap(x, y)) return false;
+
+	int tile = x + (y << 8);
+	if (flow_stamp[tile] != flow_generation) return false;
+	if (tile == flow_origin) {
+		waypoint = to;
+		return true;
+	}
+
+	int best = -1;
+	int best_dist = flow_dist[tile];
+	for (int i=0; i<8; i++) {
+		if (!canStep(x, y, step_x[i], step_y[i])) continue;
+		int n = (x + step_x[i]) + ((y + step_y[i]) << 8);
+		if (flow_stamp[n] != flow_generation) continue;
+		if (flow_dist[n] < best_dist) {
+			best = n;
+			best_dist = flow_dist[n];
+		}
+	}
+	if (best == -1) return false;
+
+	waypoint.x = ((best & 255) << TILE_SHIFT) + UNITS_PER_TILE/2;
+	waypoint.y = ((best >> 8) << TILE_SHIFT) + UNITS_PER_TILE/2;
+	return true;
+}
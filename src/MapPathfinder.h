@@ -0,0 +1,116 @@
+/**
+ * class MapPathfinder
+ *
+ * A* search over the collision grid, shared by everything that walks.
+ * Searches run under a per-frame node budget and resume on later frames;
+ * finished paths are cached until the collision map changes.
+ * A flow field toward the hero serves every enemy chasing the hero at once.
+ *
+ * @license GPL
+ */
+
+#ifndef MAP_PATHFINDER_H
+#define MAP_PATHFINDER_H
+
+#include "Utils.h"
+#include "Settings.h"
+#include "MapCollision.h"
+
+const int PATH_NODE_BUDGET = 1024; // nodes expanded per frame, across all requests
+const int PATH_MAX_NODES = 4096; // a single search gives up after this many nodes
+const int PATH_MAX_REQUESTS = 32;
+const int PATH_OPEN_POOL = 32768; // open list entries, reused by every search
+const int PATH_CACHE_SIZE = 4096; // power of two
+const int FLOW_OPEN_POOL = 32768;
+
+// findPath() results
+const int PATH_PENDING = 0;
+const int PATH_FOUND = 1;
+const int PATH_NONE = 2;
+
+// grid step costs (straight, diagonal)
+const int PATH_COST_STRAIGHT = 10;
+const int PATH_COST_DIAGONAL = 14;
+
+struct PathOpenNode {
+	int tile; // x + y*256
+	int f;
+};
+
+struct PathRequest {
+	int start;
+	int goal;
+};
+
+/**
+ * First step of the path from start toward goal (next == -1 if unreachable)
+ */
+struct PathCacheEntry {
+	int start;
+	int goal;
+	int next;
+	int generation;
+};
+
+class MapPathfinder {
+private:
+	MapCollision *collider;
+
+	// search state for the request at the front of the queue
+	int g[256*256];
+	int parent[256*256];
+	int visited[256*256]; // search id that last touched this tile
+	int closed[256*256]; // search id that closed this tile
+	int search_id;
+	bool search_active;
+	int search_nodes;
+
+	PathOpenNode open[PATH_OPEN_POOL];
+	int open_count;
+
+	PathRequest requests[PATH_MAX_REQUESTS];
+	int request_head;
+	int request_count;
+
+	PathCacheEntry cache[PATH_CACHE_SIZE];
+	int cache_generation;
+
+	int budget;
+
+	// flow field: path distance from every tile near the hero to the hero's tile
+	int flow_dist[256*256];
+	int flow_stamp[256*256]; // flow_generation that last reached this tile
+	int flow_generation;
+	int flow_origin; // hero tile the field was built from, or -1
+	int flow_limit; // largest distance stored, in step cost units
+	bool flow_dirty;
+	PathOpenNode flow_open[FLOW_OPEN_POOL];
+	int flow_open_count;
+
+	bool walkable(int x, int y);
+	bool canStep(int x, int y, int dx, int dy);
+	int heuristic(int tile, int goal);
+	void openPush(PathOpenNode *heap, int &count, int tile, int f);
+	int openPop(PathOpenNode *heap, int &count);
+	PathCacheEntry *cacheSlot(int start, int goal);
+	void cacheStore(int start, int goal, int next);
+	void finishRequest();
+	void process();
+	void buildFlowField();
+
+public:
+	MapPathfinder();
+	void setCollision(MapCollision *_collider);
+	void invalidate();
+	void logic();
+	int findPath(Point from, Point to, Point &waypoint);
+	void updateFlowField(Point hero_pos, int reach);
+	bool flowStep(Point from, Point to, Point &waypoint);
+
+	// statistics
+	int nodes_expanded;
+	int cache_hits;
+	int flow_builds;
+};
+
+#endif
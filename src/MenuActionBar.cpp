@@ -25,6 +25,7 @@ MenuActionBar::MenuActionBar(SDL_Surface *_screen, FontEngine *_font, InputState
 	label_src.w = 640;
 	label_src.h = 10;
 	drag_prev_slot = -1;
+	panel_valid = false;
 	
 	clear();
 	
@@ -85,26 +86,19 @@ void MenuActionBar::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/actionbar_trim.png", false);
 	
-	cleanup = emptyslot;
-	emptyslot = SDL_DisplayFormatAlpha(emptyslot);
-	SDL_FreeSurface(cleanup);
+	emptyslot = image_loader.optimize(emptyslot, "images/menus/slot_empty.png", false);
 	
-	cleanup = labels;
-	labels = SDL_DisplayFormatAlpha(labels);
-	SDL_FreeSurface(cleanup);
+	labels = image_loader.optimize(labels, "images/menus/actionbar_labels.png", false);
 	
-	cleanup = disabled;
-	disabled = SDL_DisplayFormatAlpha(disabled);
-	SDL_FreeSurface(cleanup);	
+	disabled = image_loader.optimize(disabled, "images/menus/disabled.png", false);
 	
+	panel = createPanel(background, 640, 35);
 }
 
 /**
- * generic render 32-pixel icon
+ * generic render 32-pixel icon, into the cached bar
  */
 void MenuActionBar::renderIcon(int icon_id, int x, int y) {
 	SDL_Rect src;
@@ -115,7 +109,7 @@ void MenuActionBar::renderIcon(int icon_id, int x, int y) {
 	src.w = src.h = dest.w = dest.h = 32;
 	src.x = (icon_id % 16) * 32;
 	src.y = (icon_id / 16) * 32;
-	SDL_BlitSurface(icons, &src, screen, &dest);		
+	blitPanelLayer(icons, &src, panel, &dest);		
 }
 
 void MenuActionBar::logic() {
@@ -123,15 +117,45 @@ void MenuActionBar::logic() {
 
 
 
+/**
+ * Compare the slots with the last drawn ones
+ */
+bool MenuActionBar::slotsChanged() {
+	bool changed = !panel_valid;
+	for (int i=0; i<12; i++) {
+		if (hotkeys[i] != shown_hotkeys[i] || slot_item_count[i] != shown_item_count[i] || slot_enabled[i] != shown_enabled[i]) {
+			shown_hotkeys[i] = hotkeys[i];
+			shown_item_count[i] = slot_item_count[i];
+			shown_enabled[i] = slot_enabled[i];
+			changed = true;
+		}
+	}
+	panel_valid = true;
+	return changed;
+}
+
 void MenuActionBar::render() {
+	if (!panel) return;
+	
+	if (slotsChanged()) refresh();
+	
+	SDL_Rect dest;
+	dest.x = (VIEW_W - 640)/2;
+	dest.y = VIEW_H-35;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached bar, in panel coordinates.
+ * Most of the trim is clear, so the slots are composited onto the panel.
+ */
+void MenuActionBar::refresh() {
 
 	SDL_Rect dest;
 	SDL_Rect trimsrc;
 	
-	int offset_x = (VIEW_W - 640)/2;
-	
-	dest.x = offset_x;
-	dest.y = VIEW_H-35;
+	dest.x = 0;
+	dest.y = 0;
 	dest.w = 640;
 	dest.h = 35;
 	trimsrc.x = 0;
@@ -139,34 +163,34 @@ void MenuActionBar::render() {
 	trimsrc.w = 640;
 	trimsrc.h = 35;
 	
-	SDL_BlitSurface(background, &trimsrc, screen, &dest);	
+	blitPanelBackground(background, &trimsrc, panel, &dest);	
 	
 	// draw hotkeyed icons
 	src.x = src.y = 0;
 	src.w = src.h = dest.w = dest.h = 32;
-	dest.y = VIEW_H-32;	
+	dest.y = 3;	
 	for (int i=0; i<12; i++) {
 
 		if (i<=9)
-			dest.x = offset_x + (i * 32) + 32;
+			dest.x = (i * 32) + 32;
 		else
-			dest.x = offset_x + (i * 32) + 64;
+			dest.x = (i * 32) + 64;
 
 		if (hotkeys[i] != -1)
 			renderIcon(powers->powers[hotkeys[i]].icon, dest.x, dest.y);
 		else
-			SDL_BlitSurface(emptyslot, &src, screen, &dest);
+			blitPanelLayer(emptyslot, &src, panel, &dest);
 	}
 	
 	renderItemCounts();
 	
 	// draw hotkey labels
 	// TODO: keybindings
-	dest.x = offset_x;
-	dest.y = VIEW_H-10;
+	dest.x = 0;
+	dest.y = 25;
 	dest.w = 640;
 	dest.h = 10;
-	SDL_BlitSurface(labels, &label_src, screen, &dest);
+	blitPanelLayer(labels, &label_src, panel, &dest);
 	
 }
 
@@ -175,24 +199,24 @@ void MenuActionBar::render() {
  */
 void MenuActionBar::renderItemCounts() {
 
-	stringstream ss;
 	SDL_Rect src;
+	SDL_Rect dest;
+	int offset_x = (VIEW_W - 640)/2;
 	
 	for (int i=0; i<12; i++) {
+		dest.x = slots[i].x - offset_x;
+		dest.y = slots[i].y - (VIEW_H-35);
 
 		if (!slot_enabled[i]) {
 			src.x = src.y = 0;
 			src.w = src.h = 32;
-			SDL_BlitSurface(disabled, &src, screen, &slots[i]);
+			blitPanelLayer(disabled, &src, panel, &dest);
 		}
 
 		if (slot_item_count[i] > -1) {
 		
 
-			ss.str("");
-			ss << slot_item_count[i];
-	
-			font->render(ss.str(), slots[i].x, slots[i].y, JUSTIFY_LEFT, screen, FONT_WHITE);
+			font->render(frame_arena.format("%d", slot_item_count[i]), dest.x, dest.y, JUSTIFY_LEFT, panel, FONT_WHITE);
 		}
 	}
 }
@@ -355,4 +379,5 @@ MenuActionBar::~MenuActionBar() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(labels);
 	SDL_FreeSurface(disabled);
+	SDL_FreeSurface(panel);
 }
@@ -19,6 +19,8 @@
 #include "FontEngine.h"
 #include <string>
 #include <sstream>
+#include "FrameArena.h"
+#include "ImageLoader.h"
 
 const int MENU_CHARACTER = 0;
 const int MENU_INVENTORY = 1;
@@ -42,6 +44,15 @@ private:
 	// for now the key mappings are static.  Just use an image for the labels
 	SDL_Surface *labels;
 	
+	SDL_Surface *panel; // cached bar, redrawn when a slot changes
+	int shown_hotkeys[12];
+	int shown_item_count[12];
+	bool shown_enabled[12];
+	bool panel_valid;
+	
+	bool slotsChanged();
+	void refresh();
+	
 public:
 
 	MenuActionBar(SDL_Surface *_screen, FontEngine *_font, InputState *_inp, PowerManager *_powers, SDL_Surface *icons);
@@ -13,6 +13,7 @@ MenuCharacter::MenuCharacter(SDL_Surface *_screen, FontEngine *_font, StatBlock
 	stats = _stats;
 	
 	visible = false;
+	panel_valid = false;
 
 	loadGraphics();
 }
@@ -28,26 +29,58 @@ void MenuCharacter::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);
+	background = image_loader.optimize(background, "images/menus/character.png", false);
 	
-	cleanup = proficiency;
-	proficiency = SDL_DisplayFormatAlpha(proficiency);
-	SDL_FreeSurface(cleanup);
+	proficiency = image_loader.optimize(proficiency, "images/menus/character_proficiency.png", false);
 
-	cleanup = upgrade;
-	upgrade = SDL_DisplayFormatAlpha(upgrade);
-	SDL_FreeSurface(cleanup);
-		
+	upgrade = image_loader.optimize(upgrade, "images/menus/upgrade.png", false);
+	
+	panel = createPanel(background, 320, 416);
+}
+
+/**
+ * Compare the values shown on the sheet with the last drawn ones
+ */
+bool MenuCharacter::statsChanged() {
+	int current[22] = {
+		stats->level, stats->physical, stats->mental, stats->offense, stats->defense,
+		stats->maxhp, stats->hp_per_minute, stats->maxmp, stats->mp_per_minute,
+		stats->accuracy, stats->avoidance,
+		stats->dmg_melee_min, stats->dmg_melee_max, stats->dmg_ment_min, stats->dmg_ment_max,
+		stats->dmg_ranged_min, stats->dmg_ranged_max, stats->crit,
+		stats->absorb_min, stats->absorb_max, stats->attunement_fire, stats->attunement_ice
+	};
+	
+	bool changed = !panel_valid || stats->name != shown_name;
+	for (int i=0; i<22; i++) {
+		if (current[i] != shown[i]) {
+			shown[i] = current[i];
+			changed = true;
+		}
+	}
+	shown_name = stats->name;
+	panel_valid = true;
+	return changed;
 }
 
 void MenuCharacter::render() {
-	if (!visible) return;
+	if (!visible || !panel) return;
 	
+	if (statsChanged()) refresh();
+	
+	SDL_Rect dest;
+	dest.x = 0;
+	dest.y = (VIEW_H - 416)/2;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached sheet, in panel coordinates
+ */
+void MenuCharacter::refresh() {
 	SDL_Rect src;
 	SDL_Rect dest;
-	int offset_y = (VIEW_H - 416)/2;
+	int offset_y = 0;
 	
 	// background
 	src.x = 0;
@@ -56,101 +89,101 @@ void MenuCharacter::render() {
 	dest.y = offset_y;
 	src.w = dest.w = 320;
 	src.h = dest.h = 416;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	// labels
 	// TODO: translate()
-	font->render("Character", 160, offset_y+8, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Name", 72, offset_y+34, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Level", 248, offset_y+34, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Physical", 40, offset_y+74, JUSTIFY_LEFT, screen, FONT_WHITE);
-	font->render("Mental", 40, offset_y+138, JUSTIFY_LEFT, screen, FONT_WHITE);
-	font->render("Offense", 40, offset_y+202, JUSTIFY_LEFT, screen, FONT_WHITE);
-	font->render("Defense", 40, offset_y+266, JUSTIFY_LEFT, screen, FONT_WHITE);
-	font->render("Total HP", 152, offset_y+106, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Regen", 248, offset_y+106, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Total MP", 152, offset_y+170, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Regen", 248, offset_y+170, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Accuracy vs. Def 1", 152, offset_y+234, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("vs. Def 5", 248, offset_y+234, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Avoidance vs. Off 1", 152, offset_y+298, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("vs. Off 5", 248, offset_y+298, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Main Weapon", 120, offset_y+338, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Ranged Weapon", 120, offset_y+354, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Crit Chance", 120, offset_y+370, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Absorb", 248, offset_y+338, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Fire Resist", 248, offset_y+354, JUSTIFY_RIGHT, screen, FONT_WHITE);
-	font->render("Ice Resist", 248, offset_y+370, JUSTIFY_RIGHT, screen, FONT_WHITE);
+	font->render("Character", 160, offset_y+8, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Name", 72, offset_y+34, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Level", 248, offset_y+34, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Physical", 40, offset_y+74, JUSTIFY_LEFT, panel, FONT_WHITE);
+	font->render("Mental", 40, offset_y+138, JUSTIFY_LEFT, panel, FONT_WHITE);
+	font->render("Offense", 40, offset_y+202, JUSTIFY_LEFT, panel, FONT_WHITE);
+	font->render("Defense", 40, offset_y+266, JUSTIFY_LEFT, panel, FONT_WHITE);
+	font->render("Total HP", 152, offset_y+106, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Regen", 248, offset_y+106, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Total MP", 152, offset_y+170, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Regen", 248, offset_y+170, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Accuracy vs. Def 1", 152, offset_y+234, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("vs. Def 5", 248, offset_y+234, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Avoidance vs. Off 1", 152, offset_y+298, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("vs. Off 5", 248, offset_y+298, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Main Weapon", 120, offset_y+338, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Ranged Weapon", 120, offset_y+354, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Crit Chance", 120, offset_y+370, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Absorb", 248, offset_y+338, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Fire Resist", 248, offset_y+354, JUSTIFY_RIGHT, panel, FONT_WHITE);
+	font->render("Ice Resist", 248, offset_y+370, JUSTIFY_RIGHT, panel, FONT_WHITE);
 
 	// character data
 	stringstream ss;
-	font->render(stats->name, 83, offset_y+34, JUSTIFY_LEFT, screen, FONT_WHITE);
+	font->render(stats->name, 83, offset_y+34, JUSTIFY_LEFT, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->level;
-	font->render(ss.str(), 268, offset_y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 268, offset_y+34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->physical;
-	font->render(ss.str(), 24, offset_y+74, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 24, offset_y+74, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->mental;
-	font->render(ss.str(), 24, offset_y+138, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 24, offset_y+138, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->offense;
-	font->render(ss.str(), 24, offset_y+202, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 24, offset_y+202, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->defense;
-	font->render(ss.str(), 24, offset_y+266, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 24, offset_y+266, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->maxhp;
-	font->render(ss.str(), 172, offset_y+106, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 172, offset_y+106, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->hp_per_minute;
-	font->render(ss.str(), 268, offset_y+106, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 268, offset_y+106, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->maxmp;
-	font->render(ss.str(), 172, offset_y+170, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 172, offset_y+170, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->mp_per_minute;
-	font->render(ss.str(), 268, offset_y+170, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 268, offset_y+170, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << (stats->accuracy) << "%";
-	font->render(ss.str(), 172, offset_y+234, JUSTIFY_CENTER, screen, FONT_WHITE);	
+	font->render(ss.str(), 172, offset_y+234, JUSTIFY_CENTER, panel, FONT_WHITE);	
 	ss.str("");
 	ss << (stats->accuracy - 20) << "%";
-	font->render(ss.str(), 268, offset_y+234, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 268, offset_y+234, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << (stats->avoidance) << "%";
-	font->render(ss.str(), 172, offset_y+298, JUSTIFY_CENTER, screen, FONT_WHITE);	
+	font->render(ss.str(), 172, offset_y+298, JUSTIFY_CENTER, panel, FONT_WHITE);	
 	ss.str("");
 	ss << (stats->avoidance - 20) << "%";
-	font->render(ss.str(), 268, offset_y+298, JUSTIFY_CENTER, screen, FONT_WHITE);	
+	font->render(ss.str(), 268, offset_y+298, JUSTIFY_CENTER, panel, FONT_WHITE);	
 	ss.str("");
 	if (stats->dmg_melee_max >= stats->dmg_ment_max)
 		ss << stats->dmg_melee_min << "-" << stats->dmg_melee_max;
 	else
 		ss << stats->dmg_ment_min << "-" << stats->dmg_ment_max;
-	font->render(ss.str(), 144, offset_y+338, JUSTIFY_CENTER, screen, FONT_WHITE);	
+	font->render(ss.str(), 144, offset_y+338, JUSTIFY_CENTER, panel, FONT_WHITE);	
 	ss.str("");
 	if (stats->dmg_ranged_max > 0)
 		ss << stats->dmg_ranged_min << "-" << stats->dmg_ranged_max;
 	else
 		ss << "-";
-	font->render(ss.str(), 144, offset_y+354, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 144, offset_y+354, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->crit << "%";
-	font->render(ss.str(), 144, offset_y+370, JUSTIFY_CENTER, screen, FONT_WHITE);	
+	font->render(ss.str(), 144, offset_y+370, JUSTIFY_CENTER, panel, FONT_WHITE);	
 	ss.str("");
 	if (stats->absorb_min == stats->absorb_max)
 		ss << stats->absorb_min;
 	else
 		ss << stats->absorb_min << "-" << stats->absorb_max;
-	font->render(ss.str(), 272, offset_y+338, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 272, offset_y+338, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << (100 - stats->attunement_fire) << "%";
-	font->render(ss.str(), 272, offset_y+354, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 272, offset_y+354, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << (100 - stats->attunement_ice) << "%";
-	font->render(ss.str(), 272, offset_y+370, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), 272, offset_y+370, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	// highlight proficiencies
 	displayProficiencies(stats->physical, offset_y+64);
@@ -175,22 +208,22 @@ void MenuCharacter::render() {
 		// physical
 		if (stats->physical < 5) { // && mouse.x >= 16 && mouse.y >= offset_y+96
 			dest.y = offset_y + 96;
-			SDL_BlitSurface(upgrade, &src, screen, &dest);
+			fastBlit(upgrade, &src, panel, &dest);
 		}
 		// mental
 		if (stats->mental < 5) { // && mouse.x >= 16 && mouse.y >= offset_y+160
 			dest.y = offset_y + 160;
-			SDL_BlitSurface(upgrade, &src, screen, &dest);
+			fastBlit(upgrade, &src, panel, &dest);
 		}
 		// offense
 		if (stats->offense < 5) { // && mouse.x >= 16 && mouse.y >= offset_y+224
 			dest.y = offset_y + 224;
-			SDL_BlitSurface(upgrade, &src, screen, &dest);
+			fastBlit(upgrade, &src, panel, &dest);
 		}
 		// defense
 		if (stats->defense < 5) { // && mouse.x >= 16 && mouse.y >= offset_y+288
 			dest.y = offset_y + 288;
-			SDL_BlitSurface(upgrade, &src, screen, &dest);
+			fastBlit(upgrade, &src, panel, &dest);
 		}
 
 		
@@ -219,7 +252,7 @@ void MenuCharacter::displayProficiencies(int value, int y) {
 	
 	for (int i=2; i<= actual_value; i++) {
 		dest.x = 112 + (i-2) * 48;
-		SDL_BlitSurface(proficiency, &src, screen, &dest);
+		fastBlit(proficiency, &src, panel, &dest);
 	}
 }
 
@@ -451,4 +484,5 @@ MenuCharacter::~MenuCharacter() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(proficiency);
 	SDL_FreeSurface(upgrade);
+	SDL_FreeSurface(panel);
 }
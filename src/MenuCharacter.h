@@ -12,6 +12,7 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include "StatBlock.h"
 #include "MenuTooltip.h"
@@ -28,9 +29,16 @@ private:
 	SDL_Surface *background;
 	SDL_Surface *proficiency;
 	SDL_Surface *upgrade;
+	SDL_Surface *panel; // cached sheet, redrawn only when the shown stats change
+	
+	int shown[22];
+	string shown_name;
+	bool panel_valid;
 
 	void displayProficiencies(int value, int y);
 	void loadGraphics();
+	bool statsChanged();
+	void refresh();
 	
 public:
 	MenuCharacter(SDL_Surface *screen, FontEngine *font, StatBlock *stats);
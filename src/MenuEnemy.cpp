@@ -14,6 +14,7 @@ MenuEnemy::MenuEnemy(SDL_Surface *_screen, FontEngine *_font) {
 	font = _font;
 	loadGraphics();
 	enemy = NULL;
+	shown_enemy = NULL;
 	timeout = 0;
 }
 
@@ -28,13 +29,11 @@ void MenuEnemy::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/bar_enemy.png", false);
 	
-	cleanup = bar_hp;
-	bar_hp = SDL_DisplayFormatAlpha(bar_hp);
-	SDL_FreeSurface(cleanup);
+	bar_hp = image_loader.optimize(bar_hp, "images/menus/bar_hp.png", false);
+	
+	panel = createPanel(background, 106, 33);
 }
 
 void MenuEnemy::handleNewMap() {
@@ -48,20 +47,51 @@ void MenuEnemy::logic() {
 	if (timeout == 0) enemy = NULL;
 }
 
+/**
+ * Compare the enemy shown on the bar with the last drawn one
+ */
+bool MenuEnemy::enemyChanged() {
+	int current[3] = {enemy->stats.hp, enemy->stats.maxhp, enemy->stats.level};
+	
+	bool changed = enemy != shown_enemy || enemy->stats.name != shown_name;
+	for (int i=0; i<3; i++) {
+		if (current[i] != shown[i]) {
+			shown[i] = current[i];
+			changed = true;
+		}
+	}
+	shown_enemy = enemy;
+	shown_name = enemy->stats.name;
+	return changed;
+}
+
 void MenuEnemy::render() {
-	if (enemy == NULL) return;
+	if (enemy == NULL || !panel) return;
 	
+	if (enemyChanged()) refresh();
+	
+	SDL_Rect dest;
+	dest.x = VIEW_W_HALF-53;
+	dest.y = 0;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached bar, in panel coordinates
+ */
+void MenuEnemy::refresh() {
 	SDL_Rect src;
 	SDL_Rect dest;
 	int hp_bar_length;
 	
 	// draw trim/background
-	dest.x = VIEW_W_HALF-53;
+	src.x = src.y = 0;
+	src.w = dest.w = 106;
+	src.h = dest.h = 33;
+	dest.x = 0;
 	dest.y = 0;
-	dest.w = 106;
-	dest.h = 33;
 	
-	SDL_BlitSurface(background, NULL, screen, &dest);
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	if (enemy->stats.maxhp == 0)
 		hp_bar_length = 0;
@@ -70,7 +100,7 @@ void MenuEnemy::render() {
 
 	// draw hp bar
 	
-	dest.x = VIEW_W_HALF-50;
+	dest.x = 3;
 	dest.y = 18;
 
 	src.x = 0;
@@ -78,22 +108,18 @@ void MenuEnemy::render() {
 	src.h = 12;
 	src.w = hp_bar_length;	
 	
-	SDL_BlitSurface(bar_hp, &src, screen, &dest);
+	fastBlit(bar_hp, &src, panel, &dest);
 	
-	stringstream ss;
-	ss << enemy->stats.name << " level " << enemy->stats.level;
-	font->render(ss.str(), VIEW_W_HALF, 4, JUSTIFY_CENTER, screen, FONT_WHITE);
-	ss.str("");
+	// the name stands above the trim, on the map
+	font->render(frame_arena.format("%s level %d", enemy->stats.name.c_str(), enemy->stats.level), 53, 4, JUSTIFY_CENTER, panel, FONT_WHITE);
 	if (enemy->stats.hp > 0)
-		ss << enemy->stats.hp << "/" << enemy->stats.maxhp;
+		font->render(frame_arena.format("%d/%d", enemy->stats.hp, enemy->stats.maxhp), 53, 19, JUSTIFY_CENTER, panel, FONT_WHITE);
 	else
-		ss << "Dead";
-	font->render(ss.str(), VIEW_W_HALF, 19, JUSTIFY_CENTER, screen, FONT_WHITE);
-	
-	//SDL_UpdateRects(screen, 1, &dest);
+		font->render("Dead", 53, 19, JUSTIFY_CENTER, panel, FONT_WHITE);
 }
 
 MenuEnemy::~MenuEnemy() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(bar_hp);		
+	SDL_FreeSurface(panel);
 }
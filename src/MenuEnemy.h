@@ -14,9 +14,11 @@
 #include "SDL_image.h"
 #include "StatBlock.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include <string>
 #include <sstream>
+#include "FrameArena.h"
 #include "Enemy.h"
 
 const int MENU_ENEMY_TIMEOUT = FRAMES_PER_SEC * 10;
@@ -27,6 +29,14 @@ private:
 	FontEngine *font;
 	SDL_Surface *background;
 	SDL_Surface *bar_hp;
+	SDL_Surface *panel; // cached bar, redrawn when the enemy or its hp change
+	
+	Enemy *shown_enemy;
+	int shown[3];
+	string shown_name;
+	
+	bool enemyChanged();
+	void refresh();
 public:
 	MenuEnemy(SDL_Surface *_screen, FontEngine *_font);
 	~MenuEnemy();
@@ -32,6 +32,9 @@ MenuExperience::MenuExperience(SDL_Surface *_screen, FontEngine *_font) {
 	text_offset.y = 12;
 	text_justify = JUSTIFY_LEFT;
 	text_label = "XP: ";
+	
+	panel = createPanel(background, hud_position.w, hud_position.h);
+	panel_valid = false;
 }
 
 void MenuExperience::loadGraphics() {
@@ -46,13 +49,9 @@ void MenuExperience::loadGraphics() {
 	}
 
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/menu_xp.png", false);
 	
-	cleanup = bar;
-	bar = SDL_DisplayFormatAlpha(bar);
-	SDL_FreeSurface(cleanup);
+	bar = image_loader.optimize(bar, "images/menus/bar_xp.png", false);
 }
 
 /**
@@ -60,22 +59,48 @@ void MenuExperience::loadGraphics() {
  * On mouseover, display progress in text form.
  */
 void MenuExperience::render(StatBlock *stats, Point mouse) {
-	SDL_Rect src;
-	SDL_Rect dest;
-	int xp_bar_length;
 	
 	// don't display anything if max level
 	// TODO: change this implementation if max level is configurable
-	if (stats->level < 1 || stats->level >= 17) return;
+	if (stats->level < 1 || stats->level >= 17 || !panel) return;
+	
+	// the total only shows on mouseover, so otherwise only the bar length matters
+	bool hover = isWithin(hud_position, mouse);
+	int required = stats->xp_table[stats->level] - stats->xp_table[stats->level-1];
+	int current_xp = stats->xp - stats->xp_table[stats->level-1];
+	int current[4] = {stats->level, (current_xp * bar_size.x) / required, hover, hover ? stats->xp : 0};
+	
+	bool changed = !panel_valid;
+	for (int i=0; i<4; i++) {
+		if (current[i] != shown[i]) {
+			shown[i] = current[i];
+			changed = true;
+		}
+	}
+	if (changed) refresh(stats, hover);
+	
+	SDL_Rect dest;
+	dest.x = hud_position.x;
+	dest.y = hud_position.y;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached bar, in panel coordinates
+ */
+void MenuExperience::refresh(StatBlock *stats, bool hover) {
+	SDL_Rect src;
+	SDL_Rect dest;
+	int xp_bar_length;
 	
 	// lay down the background image first
 	src.x = 0;
 	src.y = 0;
 	src.w = background_size.x;
 	src.h = background_size.y;
-	dest.x = hud_position.x + background_offset.x;
-	dest.y = hud_position.y + background_offset.y;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	dest.x = background_offset.x;
+	dest.y = background_offset.y;
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	// calculate the length of the xp bar
 	// when at a new level, 0% progress
@@ -86,23 +111,24 @@ void MenuExperience::render(StatBlock *stats, Point mouse) {
 	xp_bar_length = (current * bar_size.x) / required;
 	src.w = xp_bar_length;
 	src.h = bar_size.y;
-	dest.x = hud_position.x + bar_offset.x;
-	dest.y = hud_position.y + bar_offset.y;
+	dest.x = bar_offset.x;
+	dest.y = bar_offset.y;
 		
 	// draw xp bar
-	SDL_BlitSurface(bar, &src, screen, &dest);		
+	fastBlit(bar, &src, panel, &dest);		
 	
 	// if mouseover, draw text
-	if (isWithin(hud_position, mouse)) {
-		stringstream ss;
-		ss.str("");
-		ss << text_label << stats->xp << "/" << stats->xp_table[stats->level];
-		font->render(ss.str(), hud_position.x + text_offset.x, hud_position.y + text_offset.y, text_justify, screen, FONT_WHITE);
+	if (hover) {
+		const char *text = frame_arena.format("%s%d/%d", text_label.c_str(), stats->xp, stats->xp_table[stats->level]);
+		font->render(text, text_offset.x, text_offset.y, text_justify, panel, FONT_WHITE);
 	}
+	
+	panel_valid = true;
 }
 
 MenuExperience::~MenuExperience() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(bar);
+	SDL_FreeSurface(panel);
 }
 
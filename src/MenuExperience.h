@@ -15,9 +15,11 @@
 #include "SDL_mixer.h"
 #include "StatBlock.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include <string>
 #include <sstream>
+#include "FrameArena.h"
 
 using namespace std;
 
@@ -27,6 +29,12 @@ private:
 	FontEngine *font;
 	SDL_Surface *background;
 	SDL_Surface *bar;
+	SDL_Surface *panel; // cached hud_position area, redrawn when what it shows changes
+	
+	int shown[4];
+	bool panel_valid;
+	
+	void refresh(StatBlock *stats, bool hover);
 public:
 	MenuExperience(SDL_Surface *_screen, FontEngine *_font);
 	~MenuExperience();
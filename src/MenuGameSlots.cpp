@@ -183,9 +183,9 @@ void MenuGameSlots::loadPreview(int slot) {
 	src.y = 768; // for this meny we only need facing down
 	dest.y = 0;
 	
-	if (gfx_body) SDL_BlitSurface(gfx_body, &src, sprites[slot], &dest);
-	if (gfx_main) SDL_BlitSurface(gfx_main, &src, sprites[slot], &dest);
-	if (gfx_off) SDL_BlitSurface(gfx_off, &src, sprites[slot], &dest);
+	if (gfx_body) fastBlit(gfx_body, &src, sprites[slot], &dest);
+	if (gfx_main) fastBlit(gfx_main, &src, sprites[slot], &dest);
+	if (gfx_off) fastBlit(gfx_off, &src, sprites[slot], &dest);
 	// TODO: add gfx_head
 
 	if (gfx_body) SDL_FreeSurface(gfx_body);
@@ -252,14 +252,14 @@ void MenuGameSlots::render() {
 	src.x = src.y = 0;
 	dest.x = slot_pos[0].x;
 	dest.y = slot_pos[0].y;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	fastBlit(background, &src, screen, &dest);
 	
 	// display selection
 	if (selected_slot >= 0) {
 		src.w = 288;
 		src.h = 96;
 		src.x = src.y = 0;
-		SDL_BlitSurface(selection, &src, screen, &slot_pos[selected_slot]);	
+		fastBlit(selection, &src, screen, &slot_pos[selected_slot]);	
 	}
 	
 	Point label;
@@ -316,7 +316,7 @@ void MenuGameSlots::render() {
 			src.y = 0;
 			src.w = src.h = 128;
 			
-			SDL_BlitSurface(sprites[slot], &src, screen, &dest);
+			fastBlit(sprites[slot], &src, screen, &dest);
 			
 		}
 		else {
@@ -12,6 +12,7 @@
 MenuHPMP::MenuHPMP(SDL_Surface *_screen, FontEngine *_font) {
 	screen = _screen;
 	font = _font;
+	panel_valid = false;
 	
 	loadGraphics();
 }
@@ -28,21 +29,45 @@ void MenuHPMP::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/bar_hp_mp.png", false);
 	
-	cleanup = bar_hp;
-	bar_hp = SDL_DisplayFormatAlpha(bar_hp);
-	SDL_FreeSurface(cleanup);
+	bar_hp = image_loader.optimize(bar_hp, "images/menus/bar_hp.png", false);
 	
-	cleanup = bar_mp;
-	bar_mp = SDL_DisplayFormatAlpha(bar_mp);
-	SDL_FreeSurface(cleanup);
+	bar_mp = image_loader.optimize(bar_mp, "images/menus/bar_mp.png", false);
 	
+	panel = createPanel(background, 106, 33);
 }
 
 void MenuHPMP::render(StatBlock *stats, Point mouse) {
+	if (!panel) return;
+	
+	// the numbers only show on mouseover, so otherwise only the bar lengths matter
+	bool hover = (mouse.x <= 106 && mouse.y <= 33);
+	int current[7] = {
+		stats->hp, stats->maxhp, stats->mp, stats->maxmp, hover,
+		(stats->maxhp == 0) ? 0 : (stats->hp * 100) / stats->maxhp,
+		(stats->maxmp == 0) ? 0 : (stats->mp * 100) / stats->maxmp
+	};
+	if (!hover) current[0] = current[1] = current[2] = current[3] = 0;
+	
+	bool changed = !panel_valid;
+	for (int i=0; i<7; i++) {
+		if (current[i] != shown[i]) {
+			shown[i] = current[i];
+			changed = true;
+		}
+	}
+	if (changed) refresh(stats, hover);
+	
+	SDL_Rect dest;
+	dest.x = dest.y = 0;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached bars
+ */
+void MenuHPMP::refresh(StatBlock *stats, bool hover) {
 	SDL_Rect src;
 	SDL_Rect dest;
 	int hp_bar_length;
@@ -54,7 +79,7 @@ void MenuHPMP::render(StatBlock *stats, Point mouse) {
 	src.w = dest.w = 106;
 	src.h = dest.h = 33;
 	
-	SDL_BlitSurface(background, &src, screen, &dest);
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	if (stats->maxhp == 0)
 		hp_bar_length = 0;
@@ -73,30 +98,28 @@ void MenuHPMP::render(StatBlock *stats, Point mouse) {
 	dest.x = 3;
 	dest.y = 3;
 	src.w = hp_bar_length;	
-	SDL_BlitSurface(bar_hp, &src, screen, &dest);
+	fastBlit(bar_hp, &src, panel, &dest);
 	
 	// draw mp bar
 	dest.y = 18;
 	src.w = mp_bar_length;
-	SDL_BlitSurface(bar_mp, &src, screen, &dest);		
+	fastBlit(bar_mp, &src, panel, &dest);		
 	
 	// if mouseover, draw text
-	if (mouse.x <= 106 && mouse.y <= 33) {
+	if (hover) {
 
-		stringstream ss;
-		ss << stats->hp << "/" << stats->maxhp;
-		font->render(ss.str(), 53,4,JUSTIFY_CENTER, screen, FONT_WHITE);
-		ss.str("");
-		ss << stats->mp << "/" << stats->maxmp;
-		font->render(ss.str(), 53,19,JUSTIFY_CENTER, screen, FONT_WHITE);
+		font->render(frame_arena.format("%d/%d", stats->hp, stats->maxhp), 53,4,JUSTIFY_CENTER, panel, FONT_WHITE);
+		font->render(frame_arena.format("%d/%d", stats->mp, stats->maxmp), 53,19,JUSTIFY_CENTER, panel, FONT_WHITE);
 	 
 	}
+	
+	panel_valid = true;
 }
 
 MenuHPMP::~MenuHPMP() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(bar_hp);
 	SDL_FreeSurface(bar_mp);
-	
+	SDL_FreeSurface(panel);
 }
 
@@ -14,9 +14,11 @@
 #include "SDL_image.h"
 #include "StatBlock.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include <string>
 #include <sstream>
+#include "FrameArena.h"
 
 using namespace std;
 
@@ -27,6 +29,12 @@ private:
 	SDL_Surface *background;
 	SDL_Surface *bar_hp;
 	SDL_Surface *bar_mp;
+	SDL_Surface *panel; // cached bars, redrawn when what they show changes
+	
+	int shown[7];
+	bool panel_valid;
+	
+	void refresh(StatBlock *stats, bool hover);
 public:
 	MenuHPMP(SDL_Surface *_screen, FontEngine *_font);
 	~MenuHPMP();
@@ -11,6 +11,7 @@ MenuHUDLog::MenuHUDLog(SDL_Surface *_screen, FontEngine *_font) {
 	screen = _screen;
 	font = _font;
 	
+	log_start = 0;
 	log_count = 0;
 	list_area.x = 224;
 	list_area.y = 416;
@@ -26,13 +27,20 @@ int MenuHUDLog::calcDuration(string s) {
 	return FRAMES_PER_SEC * 5 + s.length() * (FRAMES_PER_SEC/10);
 }
 
+int MenuHUDLog::msgIndex(int i) {
+	return (log_start + i) % MAX_HUD_MESSAGES;
+}
+
 /**
  * Perform one frame of logic
- * Age messages
+ * Age messages. Newer messages never expire before older ones,
+ * so stop at the first one that already has.
  */
 void MenuHUDLog::logic() {
-	for (int i=0; i<log_count; i++)
-		if (msg_age[i] > 0) msg_age[i]--;
+	for (int i=log_count-1; i>=0; i--) {
+		if (msg_age[msgIndex(i)] == 0) return;
+		msg_age[msgIndex(i)]--;
+	}
 }
 
 
@@ -40,19 +48,18 @@ void MenuHUDLog::logic() {
  * New messages appear on the screen for a brief time
  */
 void MenuHUDLog::render() {
-	Point size;
 	int cursor_y;
 	
 	cursor_y = VIEW_H - 40;
 	
 	// go through new messages
 	for (int i=log_count-1; i>=0; i--) {
-		if (msg_age[i] > 0 && cursor_y > 32) {
+		int index = msgIndex(i);
+		if (msg_age[index] > 0 && cursor_y > 32) {
 		
-			size = font->calc_size(log_msg[i], list_area.x);
-			cursor_y -= size.y + paragraph_spacing;
+			cursor_y -= msg_size[index].y + paragraph_spacing;
 	
-			font->render(log_msg[i], 32, cursor_y, JUSTIFY_LEFT, screen, list_area.x, FONT_WHITE);
+			font->render(log_msg[index], 32, cursor_y, JUSTIFY_LEFT, screen, list_area.x, FONT_WHITE);
 			
 		}
 		else return; // no more new messages
@@ -65,31 +72,33 @@ void MenuHUDLog::render() {
  */
 void MenuHUDLog::add(string s) {
 
+	int index;
+	
 	if (log_count == MAX_HUD_MESSAGES) {
-
-		// remove oldest message
-		for (int i=0; i<MAX_HUD_MESSAGES-1; i++) {
-			log_msg[i] = log_msg[i+1];
-			msg_age[i] = msg_age[i+1];
-		}
-
-		log_count--;
+		// overwrite the oldest message
+		index = log_start;
+		log_start = (log_start + 1) % MAX_HUD_MESSAGES;
+	}
+	else {
+		index = msgIndex(log_count);
+		log_count++;
 	}
 	
 	// add new message
-	log_msg[log_count] = s;
-	msg_age[log_count] = calcDuration(s);
+	log_msg[index] = s;
+	msg_age[index] = calcDuration(s);
+	msg_size[index] = font->calc_size(s, list_area.x);
 	
 	// force HUD messages to vanish in order
-	if (log_count > 0) {
-		if (msg_age[log_count] < msg_age[log_count-1])
-			msg_age[log_count] = msg_age[log_count-1];
+	if (log_count > 1) {
+		int prev = msgIndex(log_count-2);
+		if (msg_age[index] < msg_age[prev])
+			msg_age[index] = msg_age[prev];
 	}
-	
-	log_count++;
 }
 
 void MenuHUDLog::clear() {
+	log_start = 0;
 	log_count = 0;
 }
 
@@ -20,11 +20,16 @@ class MenuHUDLog{
 private:
 
 	int calcDuration(string s);
+	int msgIndex(int i);
 
 	SDL_Surface *screen;
 	FontEngine *font;
+	
+	// ring buffer; message i (0 is the oldest) is at msgIndex(i)
 	string log_msg[MAX_HUD_MESSAGES];
 	int msg_age[MAX_HUD_MESSAGES];
+	Point msg_size[MAX_HUD_MESSAGES]; // wrapped size, measured once in add()
+	int log_start;
 	int log_count;
 	int paragraph_spacing;
 	
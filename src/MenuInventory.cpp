@@ -15,6 +15,8 @@ MenuInventory::MenuInventory(SDL_Surface *_screen, FontEngine *_font, ItemDataba
 	powers = _powers;
 	
 	visible = false;
+	panel_valid = false;
+	shown_gold = 0;
 	loadGraphics();
 
 	window_area.w = 320;
@@ -51,9 +53,9 @@ void MenuInventory::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/inventory.png", false);
+	
+	panel = createPanel(background, 320, 416);
 }
 
 void MenuInventory::logic() {
@@ -69,8 +71,23 @@ void MenuInventory::logic() {
 }
 
 void MenuInventory::render() {
-	if (!visible) return;
+	if (!visible || !panel) return;
+	
+	// check both grids, so each keeps its snapshot current
+	bool equipment_changed = inventory[EQUIPMENT].changed();
+	bool carried_changed = inventory[CARRIED].changed();
+	if (!panel_valid || equipment_changed || carried_changed || gold != shown_gold) refresh();
+	
+	SDL_Rect dest = window_area;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached window, in panel coordinates
+ */
+void MenuInventory::refresh() {
 	SDL_Rect src;
+	SDL_Rect dest;
 	stringstream ss;
 	
 	// background
@@ -78,21 +95,26 @@ void MenuInventory::render() {
 	src.y = 0;
 	src.w = window_area.w;
 	src.h = window_area.h;
-	SDL_BlitSurface(background, &src, screen, &window_area);
+	dest.x = 0;
+	dest.y = 0;
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	// text overlay
 	// TODO: translate()
-	font->render("Inventory", window_area.x+160, window_area.y+8, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Main Hand", window_area.x+64, window_area.y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Body", window_area.x+128, window_area.y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Off Hand", window_area.x+192, window_area.y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Artifact", window_area.x+256, window_area.y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render("Inventory", 160, 8, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Main Hand", 64, 34, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Body", 128, 34, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Off Hand", 192, 34, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Artifact", 256, 34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	ss << gold << " Gold";
-	font->render(ss.str(), window_area.x+288, window_area.y+114, JUSTIFY_RIGHT, screen, FONT_WHITE);
+	font->render(ss.str(), 288, 114, JUSTIFY_RIGHT, panel, FONT_WHITE);
 
-	inventory[EQUIPMENT].render();
-	inventory[CARRIED].render();
+	inventory[EQUIPMENT].render(panel, window_area.x, window_area.y);
+	inventory[CARRIED].render(panel, window_area.x, window_area.y);
+	
+	shown_gold = gold;
+	panel_valid = true;
 }
 
 int MenuInventory::areaOver(Point mouse) {
@@ -493,4 +515,5 @@ void MenuInventory::updateEquipment(int slot) {
 
 MenuInventory::~MenuInventory() {
 	SDL_FreeSurface(background);
+	SDL_FreeSurface(panel);
 }
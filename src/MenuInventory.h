@@ -19,6 +19,7 @@
 #include "StatBlock.h"
 #include "PowerManager.h"
 #include "MenuItemStorage.h"
+#include "ImageLoader.h"
 #include <string>
 #include <sstream>
 
@@ -47,8 +48,12 @@ private:
 	void loadGraphics();
 	int areaOver(Point mouse);
 	void updateEquipment(int slot);
+	void refresh();
 
 	SDL_Surface *background;
+	SDL_Surface *panel; // cached window, redrawn when the slots or gold change
+	bool panel_valid;
+	int shown_gold;
 	
 public:
 	MenuInventory(SDL_Surface *screen, FontEngine *font, ItemDatabase *items, StatBlock *stats, PowerManager *powers);
@@ -14,16 +14,47 @@ void MenuItemStorage::init(int _slot_number, ItemDatabase *_items, SDL_Surface *
 	area = _area;
 	icon_size = _icon_size;
 	nb_cols = _nb_cols;
+	
+	shown = new ItemStack[slot_number];
+	for (int i=0; i<slot_number; i++) {
+		shown[i].item = -1;
+		shown[i].quantity = 0;
+	}
+}
+
+MenuItemStorage::~MenuItemStorage() {
+	delete[] shown;
 }
 
 void MenuItemStorage::render() {
+	render(screen, 0, 0);
+}
+
+/**
+ * Render the slots onto a surface whose top-left is at (offset_x, offset_y) on screen
+ */
+void MenuItemStorage::render(SDL_Surface *target, int offset_x, int offset_y) {
 	for (int i=0; i<slot_number; i++) {
 		if (storage[i].item > 0) {
-			items->renderIcon(storage[i], area.x + (i % nb_cols * icon_size), area.y + (i / nb_cols * icon_size), icon_size);
+			items->renderIcon(storage[i], area.x - offset_x + (i % nb_cols * icon_size), area.y - offset_y + (i / nb_cols * icon_size), icon_size, target);
 		}	
 	}
 }
 
+/**
+ * Compare the slots with the last rendered contents
+ */
+bool MenuItemStorage::changed() {
+	bool changed = false;
+	for (int i=0; i<slot_number; i++) {
+		if (storage[i].item != shown[i].item || storage[i].quantity != shown[i].quantity) {
+			shown[i] = storage[i];
+			changed = true;
+		}
+	}
+	return changed;
+}
+
 int MenuItemStorage::slotOver(Point mouse) {
 	if( isWithin( area, mouse)) {
 		return (mouse.x - area.x) / icon_size + (mouse.y - area.y) / icon_size * nb_cols;
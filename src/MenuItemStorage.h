@@ -21,12 +21,16 @@ protected:
 	SDL_Rect area;
 	int icon_size;
 	int nb_cols;
+	ItemStack *shown; // slot contents at the last render, for cached menu panels
 
 public:
 	void init(int _slot_number, ItemDatabase *_items, SDL_Surface *_screen, FontEngine *_font, SDL_Rect _area, int icon_size, int nb_cols);
+	~MenuItemStorage();
 
 	// rendering
 	void render();
+	void render(SDL_Surface *target, int offset_x, int offset_y);
+	bool changed();
 	int slotOver(Point mouse);
 	TooltipData checkTooltip(Point mouse, StatBlock *stats, bool vendor_view);
 	ItemStack click(InputState * input);
@@ -12,8 +12,10 @@ MenuLog::MenuLog(SDL_Surface *_screen, FontEngine *_font) {
 	font = _font;
 
 	visible = false;
+	panel_valid = false;
 	
 	for (int i=0; i<LOG_TYPE_COUNT; i++) {
+		log_start[i] = 0;
 		log_count[i] = 0;
 	}
 	active_log = 0;
@@ -75,17 +77,13 @@ void MenuLog::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/log.png", false);
 
-	cleanup = tab_active;
-	tab_active = SDL_DisplayFormatAlpha(tab_active);
-	SDL_FreeSurface(cleanup);	
+	tab_active = image_loader.optimize(tab_active, "images/menus/tab_active.png", false);
 
-	cleanup = tab_inactive;
-	tab_inactive = SDL_DisplayFormatAlpha(tab_inactive);
-	SDL_FreeSurface(cleanup);	
+	tab_inactive = image_loader.optimize(tab_inactive, "images/menus/tab_inactive.png", false);
+	
+	panel = createPanel(background, menu_area.w, menu_area.h);
 }
 
 /**
@@ -99,20 +97,34 @@ void MenuLog::logic() {
  */
 void MenuLog::render() {
 
-	if (!visible) return;
+	if (!visible || !panel) return;
+	
+	if (!panel_valid) refresh();
+	
+	SDL_Rect dest = menu_area;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached log window, in panel coordinates
+ */
+void MenuLog::refresh() {
 	
 	SDL_Rect src;
+	SDL_Rect dest;
 	
 	// background
 	src.x = 0;
 	src.y = 0;
 	src.w = menu_area.w;
 	src.h = menu_area.h;
-	SDL_BlitSurface(background, &src, screen, &menu_area);
+	dest.x = 0;
+	dest.y = 0;
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	// text overlay
 	// TODO: translate()
-	font->render("Log", menu_area.x+160, menu_area.y+8, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render("Log", 160, 8, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	
 	// display tabs
@@ -122,27 +134,25 @@ void MenuLog::render() {
 	
 	// display latest log messages
 	
-	Point size;
 	int display_number = 0;
 	int total_size = 0;
 
 	// first calculate how many entire messages can fit in the log view
 	for (int i=log_count[active_log]-1; i>=0; i--) {
-		size = font->calc_size(log_msg[active_log][i], list_area.w);
-		total_size += size.y + paragraph_spacing;
+		total_size += msg_size[active_log][msgIndex(active_log, i)].y + paragraph_spacing;
 		if (total_size < list_area.h) display_number++;
 		else break;
 	}
 	
 	// now display these messages
-	int cursor_y = list_area.y;
+	int cursor_y = list_area.y - menu_area.y;
 	for (int i=log_count[active_log]-display_number; i<log_count[active_log]; i++) {
-		
-		size = font->calc_size(log_msg[active_log][i], list_area.w);	
-		font->render(log_msg[active_log][i], list_area.x, cursor_y, JUSTIFY_LEFT, screen, list_area.w, FONT_WHITE);
-		cursor_y += size.y + paragraph_spacing;
+		int index = msgIndex(active_log, i);
+		font->render(log_msg[active_log][index], list_area.x - menu_area.x, cursor_y, JUSTIFY_LEFT, panel, list_area.w, FONT_WHITE);
+		cursor_y += msg_size[active_log][index].y + paragraph_spacing;
 	}
 
+	panel_valid = true;
 }
 
 /**
@@ -153,29 +163,32 @@ void MenuLog::render() {
 void MenuLog::renderTab(int log_type) {
 	int i = log_type;
 	
-	// draw tab background
+	// draw tab background, in panel coordinates
 	SDL_Rect src;
 	SDL_Rect dest;
+	int tab_x = tab_rect[i].x - menu_area.x;
+	int tab_y = tab_rect[i].y - menu_area.y;
 	src.x = src.y = 0;
-	dest.x = tab_rect[i].x;
-	dest.y = tab_rect[i].y;
+	dest.x = tab_x;
+	dest.y = tab_y;
 	src.w = tab_rect[i].w;
 	src.h = tab_rect[i].h;
 	
 	if (i == active_log)
-		SDL_BlitSurface(tab_active, &src, screen, &dest);	
+		fastBlit(tab_active, &src, panel, &dest);	
 	else
-		SDL_BlitSurface(tab_inactive, &src, screen, &dest);	
+		fastBlit(tab_inactive, &src, panel, &dest);	
 
 	// draw tab right edge
 	src.x = 128 - tab_padding.x;
 	src.w = tab_padding.x;
-	dest.x = tab_rect[i].x + tab_rect[i].w - tab_padding.x;
+	dest.x = tab_x + tab_rect[i].w - tab_padding.x;
+	dest.y = tab_y;
 	
 	if (i == active_log)
-		SDL_BlitSurface(tab_active, &src, screen, &dest);	
+		fastBlit(tab_active, &src, panel, &dest);	
 	else
-		SDL_BlitSurface(tab_inactive, &src, screen, &dest);	
+		fastBlit(tab_inactive, &src, panel, &dest);	
 	
 	
 	// set tab label text color
@@ -183,7 +196,7 @@ void MenuLog::renderTab(int log_type) {
 	if (i == active_log) tab_label_color = FONT_WHITE;
 	else tab_label_color = FONT_GREY;
 		
-	font->render(tab_labels[i], tab_rect[i].x + tab_padding.x, tab_rect[i].y + tab_padding.y, JUSTIFY_LEFT, screen, tab_label_color);		
+	font->render(tab_labels[i], tab_x + tab_padding.x, tab_y + tab_padding.y, JUSTIFY_LEFT, panel, tab_label_color);		
 }
 
 /**
@@ -191,20 +204,27 @@ void MenuLog::renderTab(int log_type) {
  */
 void MenuLog::add(string s, int log_type) {
 
+	int index;
+	
 	if (log_count[log_type] == MAX_LOG_MESSAGES) {
-
-		// remove oldest message
-		for (int i=0; i<MAX_LOG_MESSAGES-1; i++) {
-			log_msg[log_type][i] = log_msg[log_type][i+1];
-		}
-
-		log_count[log_type]--;
+		// overwrite the oldest message
+		index = log_start[log_type];
+		log_start[log_type] = (log_start[log_type] + 1) % MAX_LOG_MESSAGES;
+	}
+	else {
+		index = msgIndex(log_type, log_count[log_type]);
+		log_count[log_type]++;
 	}
 	
 	// add new message
-	log_msg[log_type][log_count[log_type]] = s;
+	log_msg[log_type][index] = s;
+	msg_size[log_type][index] = font->calc_size(s, list_area.w);
+
+	panel_valid = false;
+}
 
-	log_count[log_type]++;
+int MenuLog::msgIndex(int log_type, int i) {
+	return (log_start[log_type] + i) % MAX_LOG_MESSAGES;
 }
 
 /**
@@ -214,6 +234,7 @@ void MenuLog::add(string s, int log_type) {
 void MenuLog::clickTab(Point mouse) {
 	for (int i=0; i<LOG_TYPE_COUNT; i++) {
 		if(isWithin(tab_rect[i], mouse)) {
+			if (active_log != i) panel_valid = false;
 			active_log = i;
 			return;
 		}
@@ -221,7 +242,9 @@ void MenuLog::clickTab(Point mouse) {
 }
 
 void MenuLog::clear(int log_type) {
+	log_start[log_type] = 0;
 	log_count[log_type] = 0;
+	panel_valid = false;
 }
 
 void MenuLog::clear() {
@@ -232,4 +255,5 @@ void MenuLog::clear() {
 
 MenuLog::~MenuLog() {
 	SDL_FreeSurface(background);
+	SDL_FreeSurface(panel);
 }
@@ -13,6 +13,7 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 
 const int MAX_LOG_MESSAGES = 100;
@@ -31,11 +32,17 @@ private:
 	SDL_Surface *background;
 	SDL_Surface *tab_active;
 	SDL_Surface *tab_inactive;
+	SDL_Surface *panel; // cached log window, redrawn when messages or the active tab change
+	bool panel_valid;
 	
 	void loadGraphics();
-	void renderTab();
+	void refresh();
+	int msgIndex(int log_type, int i);
 	
+	// one ring buffer per log type; message i (0 is the oldest) is at msgIndex(type, i)
 	string log_msg[LOG_TYPE_COUNT][MAX_LOG_MESSAGES];
+	Point msg_size[LOG_TYPE_COUNT][MAX_LOG_MESSAGES]; // wrapped size, measured once in add()
+	int log_start[LOG_TYPE_COUNT];
 	int log_count[LOG_TYPE_COUNT];
 	string tab_labels[LOG_TYPE_COUNT];
 	SDL_Rect tab_rect[LOG_TYPE_COUNT];
@@ -58,9 +58,7 @@ void MenuManager::loadIcons() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = icons;
-	icons = SDL_DisplayFormatAlpha(icons);
-	SDL_FreeSurface(cleanup);	
+	icons = image_loader.optimize(icons, "images/icons/icons32.png", false);
 }
 
 void MenuManager::loadSounds() {
@@ -82,7 +80,7 @@ void MenuManager::renderIcon(int icon_id, int x, int y) {
 	src.w = src.h = dest.w = dest.h = 32;
 	src.x = (icon_id % 16) * 32;
 	src.y = (icon_id / 16) * 32;
-	SDL_BlitSurface(icons, &src, screen, &dest);		
+	fastBlit(icons, &src, screen, &dest);		
 }
 
 void MenuManager::logic() {
@@ -12,6 +12,7 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include "InputState.h"
 #include "MenuInventory.h"
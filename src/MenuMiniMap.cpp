@@ -10,33 +10,119 @@
 
 MenuMiniMap::MenuMiniMap(SDL_Surface *_screen) {
 	screen = _screen;
+	map_surface = NULL;
+	collider = NULL;
 	
 	color_wall = SDL_MapRGB(screen->format, 128,128,128);
 	color_obst = SDL_MapRGB(screen->format, 64,64,64);
 	color_hero = SDL_MapRGB(screen->format, 255,255,255);
+	
+	map_size.x = map_size.y = 0;
+	last_tile.x = last_tile.y = -1;
+	zoom = MINIMAP_ZOOM;
+	fog = MINIMAP_FOG;
+	explore_radius = 8;
 }
 
-	// TEMP: let's make a minimap
+/**
+ * Build the minimap surface for the whole map.
+ * Called once after a new map is loaded.
+ */
+void MenuMiniMap::prerender(MapCollision *_collider, int map_w, int map_h) {
+	collider = _collider;
+	map_size.x = map_w;
+	map_size.y = map_h;
+	last_tile.x = last_tile.y = -1;
+	
+	for (int i=0; i<256; i++) {
+		for (int j=0; j<256; j++) {
+			explored[i][j] = false;
+		}
+	}
+	
+	if (map_surface) SDL_FreeSurface(map_surface);
+	map_surface = SDL_CreateRGBSurface(SDL_SWSURFACE, map_w * zoom, map_h * zoom, 32,
+		screen->format->Rmask, screen->format->Gmask, screen->format->Bmask, 0);
+	if (!map_surface) {
+		fprintf(stderr, "Couldn't create minimap surface: %s\n", SDL_GetError());
+		return;
+	}
+	
+	// black is never a minimap color, so it shows the map underneath
+	SDL_FillRect(map_surface, NULL, 0);
+	SDL_SetColorKey(map_surface, SDL_SRCCOLORKEY, 0);
+	
+	for (int i=0; i<map_w; i++) {
+		for (int j=0; j<map_h; j++) {
+			renderTile(i, j);
+		}
+	}
+}
 
-void MenuMiniMap::render(MapCollision *collider, Point hero_pos, int map_w, int map_h) {
+/**
+ * Draw a single tile onto the minimap surface
+ */
+void MenuMiniMap::renderTile(int tile_x, int tile_y) {
+	SDL_Rect dest;
+	Uint32 color = 0;
+	
+	if (!fog || explored[tile_x][tile_y]) {
+		if (collider->colmap[tile_x][tile_y] == 1) color = color_wall;
+		else if (collider->colmap[tile_x][tile_y] == 2) color = color_obst;
+	}
+	
+	dest.x = tile_x * zoom;
+	dest.y = tile_y * zoom;
+	dest.w = dest.h = zoom;
+	SDL_FillRect(map_surface, &dest, color);
+}
+
+/**
+ * A mapmod changed the collision of this tile
+ */
+void MenuMiniMap::update(int tile_x, int tile_y) {
+	if (!map_surface) return;
+	if (tile_x < 0 || tile_y < 0 || tile_x >= map_size.x || tile_y >= map_size.y) return;
+	renderTile(tile_x, tile_y);
+}
+
+/**
+ * Reveal the tiles around the hero
+ */
+void MenuMiniMap::explore(Point hero_tile) {
+	for (int i=hero_tile.x - explore_radius; i<=hero_tile.x + explore_radius; i++) {
+		for (int j=hero_tile.y - explore_radius; j<=hero_tile.y + explore_radius; j++) {
+			if (i >= 0 && i < map_size.x && j >= 0 && j < map_size.y && !explored[i][j]) {
+				explored[i][j] = true;
+				renderTile(i, j);
+			}
+		}
+	}
+}
+
+void MenuMiniMap::render(Point hero_pos) {
+	if (!map_surface) return;
+	
+	SDL_Rect src;
+	SDL_Rect dest;
 	Point hero_tile;
-	Point map_tile;
 	hero_tile.x = hero_pos.x / UNITS_PER_TILE;
 	hero_tile.y = hero_pos.y / UNITS_PER_TILE;
-	for (int i=0; i<127; i++) {
-		for (int j=0; j<127; j++) {
-			map_tile.x = hero_tile.x + i - 64;
-			map_tile.y = hero_tile.y + j - 64;
-			if (map_tile.x >= 0 && map_tile.x < map_w && map_tile.y >= 0 && map_tile.y < map_h) {
-				if (collider->colmap[map_tile.x][map_tile.y] == 1) {
-					drawPixel(screen, VIEW_W - 128 + i, 16+j, color_wall);
-				}
-				else if (collider->colmap[map_tile.x][map_tile.y] == 2) {
-					drawPixel(screen, VIEW_W - 128 + i, 16+j, color_obst);
-				}
-			}
-		}
+	
+	if (fog && (hero_tile.x != last_tile.x || hero_tile.y != last_tile.y)) {
+		explore(hero_tile);
 	}
+	last_tile = hero_tile;
+
+	// the hero tile is drawn at the center of the 127x127 minimap.
+	// SDL_BlitSurface clips the source rect to the map edges.
+	src.x = hero_tile.x * zoom + zoom/2 - 64;
+	src.y = hero_tile.y * zoom + zoom/2 - 64;
+	src.w = src.h = 127;
+	dest.x = VIEW_W - 128;
+	dest.y = 16;
+	fastBlit(map_surface, &src, screen, &dest);
+	
 	drawPixel(screen,VIEW_W-64,80,color_hero); // hero
 	drawPixel(screen,VIEW_W-64-1,80,color_hero); // hero
 	drawPixel(screen,VIEW_W-64+1,80,color_hero); // hero
@@ -46,4 +132,5 @@ void MenuMiniMap::render(MapCollision *collider, Point hero_pos, int map_w, int
 }
 
 MenuMiniMap::~MenuMiniMap() {
+	if (map_surface) SDL_FreeSurface(map_surface);
 }
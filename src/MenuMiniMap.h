@@ -15,15 +15,30 @@
 class MenuMiniMap {
 private:
 	SDL_Surface *screen;
+	SDL_Surface *map_surface; // the whole map, prerendered at the current zoom
+	MapCollision *collider;
 	Uint32 color_wall;
 	Uint32 color_obst;
 	Uint32 color_hero;
+	
+	Point map_size;
+	Point last_tile;
+	bool explored[256][256];
+	
+	void renderTile(int tile_x, int tile_y);
+	void explore(Point hero_tile);
+	
 public: 
 	MenuMiniMap(SDL_Surface *_screen);
 	~MenuMiniMap();
 
-	void render(MapCollision *collider, Point hero_pos, int map_w, int map_h);
+	void prerender(MapCollision *_collider, int map_w, int map_h);
+	void update(int tile_x, int tile_y);
+	void render(Point hero_pos);
 
+	int zoom; // pixels per tile, from minimap_zoom in settings.txt
+	bool fog; // only show tiles the hero has been near, from minimap_fog
+	int explore_radius; // in tiles
 };
 
 
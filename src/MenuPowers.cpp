@@ -14,6 +14,7 @@ MenuPowers::MenuPowers(SDL_Surface *_screen, FontEngine *_font, StatBlock *_stat
 	powers = _powers;
 	
 	visible = false;
+	panel_valid = false;
 	loadGraphics();
 	
 			
@@ -39,17 +40,13 @@ void MenuPowers::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/powers.png", false);
 	
-	cleanup = powers_step;
-	powers_step = SDL_DisplayFormatAlpha(powers_step);
-	SDL_FreeSurface(cleanup);
+	powers_step = image_loader.optimize(powers_step, "images/menus/powers_step.png", false);
 	
-	cleanup = powers_unlock;
-	powers_unlock = SDL_DisplayFormatAlpha(powers_unlock);
-	SDL_FreeSurface(cleanup);
+	powers_unlock = image_loader.optimize(powers_unlock, "images/menus/powers_unlock.png", false);
+	
+	panel = createPanel(background, 320, 416);
 }
 
 /**
@@ -89,14 +86,43 @@ int MenuPowers::click(Point mouse) {
 	return -1;
 }
 
+/**
+ * Compare the build shown in the tree with the last drawn one
+ */
+bool MenuPowers::buildChanged() {
+	int current[4] = {stats->physoff, stats->physdef, stats->mentoff, stats->mentdef};
+	
+	bool changed = !panel_valid;
+	for (int i=0; i<4; i++) {
+		if (current[i] != shown[i]) {
+			shown[i] = current[i];
+			changed = true;
+		}
+	}
+	panel_valid = true;
+	return changed;
+}
+
 void MenuPowers::render() {
-	if (!visible) return;
+	if (!visible || !panel) return;
+	
+	if (buildChanged()) refresh();
 	
+	SDL_Rect dest;
+	dest.x = VIEW_W - 320;
+	dest.y = (VIEW_H - 416)/2;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached tree, in panel coordinates
+ */
+void MenuPowers::refresh() {
 	SDL_Rect src;
 	SDL_Rect dest;
 	
-	int offset_x = (VIEW_W - 320);
-	int offset_y = (VIEW_H - 416)/2;
+	int offset_x = 0;
+	int offset_y = 0;
 	
 	// background
 	src.x = 0;
@@ -105,34 +131,34 @@ void MenuPowers::render() {
 	dest.y = offset_y;
 	src.w = dest.w = 320;
 	src.h = dest.h = 416;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	blitPanelBackground(background, &src, panel, &dest);
 	
 	// text overlay
 	// TODO: translate()
-	font->render("Powers", offset_x+160, offset_y+8, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Physical", offset_x+64, offset_y+50, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Physical", offset_x+128, offset_y+50, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Mental", offset_x+192, offset_y+50, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Mental", offset_x+256, offset_y+50, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Offense", offset_x+64, offset_y+66, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Defense", offset_x+128, offset_y+66, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Offense", offset_x+192, offset_y+66, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render("Defense", offset_x+256, offset_y+66, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render("Powers", offset_x+160, offset_y+8, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Physical", offset_x+64, offset_y+50, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Physical", offset_x+128, offset_y+50, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Mental", offset_x+192, offset_y+50, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Mental", offset_x+256, offset_y+50, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Offense", offset_x+64, offset_y+66, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Defense", offset_x+128, offset_y+66, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Offense", offset_x+192, offset_y+66, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render("Defense", offset_x+256, offset_y+66, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	// stats
 	stringstream ss;
 	ss.str("");
 	ss << stats->physoff;
-	font->render(ss.str(), offset_x+64, offset_y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), offset_x+64, offset_y+34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->physdef;
-	font->render(ss.str(), offset_x+128, offset_y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), offset_x+128, offset_y+34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->mentoff;
-	font->render(ss.str(), offset_x+192, offset_y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), offset_x+192, offset_y+34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	ss.str("");
 	ss << stats->mentdef;
-	font->render(ss.str(), offset_x+256, offset_y+34, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render(ss.str(), offset_x+256, offset_y+34, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	// highlighting
 	displayBuild(stats->physoff, offset_x+48);
@@ -157,7 +183,7 @@ void MenuPowers::displayBuild(int value, int x) {
 	src_unlock.h = 45;
 
 	dest.x = x;
-	int offset_y = (VIEW_H - 416)/2;
+	int offset_y = 0;
 	
 	// save-game hackers could set their stats higher than normal.
 	// make sure this display still works.
@@ -166,11 +192,11 @@ void MenuPowers::displayBuild(int value, int x) {
 	for (int i=3; i<= display_value; i++) {
 		if (i%2 == 0) { // even stat
 			dest.y = i * 32 + offset_y + 48;
-			SDL_BlitSurface(powers_step, &src_step, screen, &dest);
+			fastBlit(powers_step, &src_step, panel, &dest);
 		}
 		else { // odd stat
 			dest.y = i * 32 + offset_y + 35;
-			SDL_BlitSurface(powers_unlock, &src_unlock, screen, &dest);
+			fastBlit(powers_unlock, &src_unlock, panel, &dest);
 		
 		}
 	}
@@ -250,4 +276,5 @@ MenuPowers::~MenuPowers() {
 	SDL_FreeSurface(background);
 	SDL_FreeSurface(powers_step);
 	SDL_FreeSurface(powers_unlock);
+	SDL_FreeSurface(panel);
 }
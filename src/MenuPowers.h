@@ -12,6 +12,7 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include "StatBlock.h"
 #include "MenuTooltip.h"
@@ -31,8 +32,15 @@ private:
 	SDL_Surface *background;
 	SDL_Surface *powers_step;
 	SDL_Surface *powers_unlock;
+	SDL_Surface *panel; // cached window, redrawn when the build changes
+	
+	int shown[4];
+	bool panel_valid;
+	
 	void loadGraphics();
 	void displayBuild(int value, int x);
+	bool buildChanged();
+	void refresh();
 
 public:
 	MenuPowers(SDL_Surface *_screen, FontEngine *_font, StatBlock *_stats, PowerManager *_powers);
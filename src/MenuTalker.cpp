@@ -14,6 +14,7 @@ MenuTalker::MenuTalker(SDL_Surface *_screen, FontEngine *_font, CampaignManager
 	npc = NULL;
 	
 	visible = false;
+	panel_valid = false;
 
 	// step through NPC dialog nodes
 	dialog_node = 0;
@@ -33,16 +34,16 @@ void MenuTalker::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/dialog_box.png", false);
 	
+	panel = createPanel(background, 640, 416);
 }
 
 void MenuTalker::chooseDialogNode() {
 	event_cursor = 0;
 	dialog_node = npc->chooseDialogNode();
 	npc->processDialog(dialog_node, event_cursor);
+	panel_valid = false;
 }
 
 /**
@@ -65,6 +66,7 @@ void MenuTalker::logic(bool pressing_accept) {
 	// pressed next/more
 	event_cursor++;
 	more = npc->processDialog(dialog_node, event_cursor);
+	panel_valid = false;
 	
 	if (!more) {
 		// end dialog
@@ -74,22 +76,36 @@ void MenuTalker::logic(bool pressing_accept) {
 }
 
 void MenuTalker::render() {
-	if (!visible) return;
+	if (!visible || !panel) return;
+	
+	if (!panel_valid) refresh();
+	
+	SDL_Rect dest;
+	dest.x = (VIEW_W - 640)/2;
+	dest.y = (VIEW_H - 416)/2;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached dialog, in panel coordinates.
+ * The box is translucent and the portrait stands on the map,
+ * so every layer is composited onto the clear panel.
+ */
+void MenuTalker::refresh() {
 	SDL_Rect src;
 	SDL_Rect dest;
 	string line;
 	
-	int offset_x = (VIEW_W - 640)/2;
-	int offset_y = (VIEW_H - 416)/2;
+	SDL_FillRect(panel, NULL, 0);
 	
 	// dialog box
 	src.x = 0;
 	src.y = 0;
-	dest.x = offset_x;
-	dest.y = offset_y + 320;
+	dest.x = 0;
+	dest.y = 320;
 	src.w = dest.w = 640;
 	src.h = dest.h = 96;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	blitPanelLayer(background, &src, panel, &dest);
 	
 	// show active portrait
 	string etype = npc->dialog[dialog_node][event_cursor].type;
@@ -97,9 +113,9 @@ void MenuTalker::render() {
 		if (npc->portrait != NULL) {
 			src.w = dest.w = 320;
 			src.h = dest.h = 320;
-			dest.x = offset_x + 48;
-			dest.y = offset_y;
-			SDL_BlitSurface(npc->portrait, &src, screen, &dest);	
+			dest.x = 48;
+			dest.y = 0;
+			blitPanelLayer(npc->portrait, &src, panel, &dest);	
 		}
 		line = npc->name + ": ";
 	}
@@ -111,10 +127,12 @@ void MenuTalker::render() {
 	
 	// text overlay
 	line = line + npc->dialog[dialog_node][event_cursor].s;
-	font->render(line, offset_x+48, offset_y+336, JUSTIFY_LEFT, screen, 544, FONT_WHITE);
+	font->render(line, 48, 336, JUSTIFY_LEFT, panel, 544, FONT_WHITE);
+	
+	panel_valid = true;
 }
 
-
 MenuTalker::~MenuTalker() {
 	SDL_FreeSurface(background);
+	SDL_FreeSurface(panel);
 }
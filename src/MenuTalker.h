@@ -12,6 +12,7 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include "NPC.h"
 #include "CampaignManager.h"
@@ -26,7 +27,10 @@ private:
 	CampaignManager *camp;
 
 	void loadGraphics();
+	void refresh();
 	SDL_Surface *background;
+	SDL_Surface *panel; // cached dialog, redrawn when the dialog moves on
+	bool panel_valid;
 
 	int dialog_node;
 
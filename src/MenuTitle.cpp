@@ -41,9 +41,7 @@ void MenuTitle::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = logo;
-	logo = SDL_DisplayFormatAlpha(logo);
-	SDL_FreeSurface(cleanup);	
+	logo = image_loader.optimize(logo, "images/menus/logo.png", false);
 }
 
 void MenuTitle::logic() {
@@ -68,7 +66,7 @@ void MenuTitle::render() {
 	src.h = dest.h = logo->h;
 	dest.x = VIEW_W_HALF - (logo->w/2);
 	dest.y = VIEW_H_HALF - (logo->h/2);
-	SDL_BlitSurface(logo, &src, screen, &dest);
+	fastBlit(logo, &src, screen, &dest);
 
 	// display buttons
 	button_play->render();
@@ -14,6 +14,7 @@
 #include "InputState.h"
 #include "FontEngine.h"
 #include "WidgetButton.h"
+#include "ImageLoader.h"
 
 class MenuTitle {
 private:
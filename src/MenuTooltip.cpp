@@ -11,7 +11,7 @@ MenuTooltip::MenuTooltip(FontEngine *_font, SDL_Surface *_screen) {
 	font = _font;
 	screen = _screen;
 	offset=12;
-	width=160;
+	width=TOOLTIP_WIDTH;
 	margin=4;
 	
 	// make the bottom margin smaller for visual balance
@@ -74,13 +74,15 @@ void MenuTooltip::render(TooltipData tip, Point pos, int style) {
 	SDL_Rect background;
 	
 	string fulltext;
+	Point size = tip.size;
 	
-	fulltext = tip.lines[0];
-	for (int i=1; i<tip.num_lines; i++) {
-		fulltext = fulltext + "\n" + tip.lines[i];
+	if (size.x == 0 || width != TOOLTIP_WIDTH) {
+		fulltext = tip.lines[0];
+		for (int i=1; i<tip.num_lines; i++) {
+			fulltext = fulltext + "\n" + tip.lines[i];
+		}
+		size = font->calc_size(fulltext, width);
 	}
-	
-	Point size = font->calc_size(fulltext, width);
 	background.w = size.x + margin + margin;
 	background.h = size.y + margin + margin_bottom;
 	
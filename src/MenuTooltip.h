@@ -18,13 +18,17 @@
 const int STYLE_FLOAT = 0;
 const int STYLE_TOPLABEL = 1;
 
+const int TOOLTIP_WIDTH = 160;
+
 struct TooltipData {
 	string lines[8];
 	int colors[8];
 	int num_lines;
+	Point size; // laid out size at TOOLTIP_WIDTH, or 0,0 if not measured yet
 	
 	TooltipData() {
 		num_lines = 0;
+		size.x = size.y = 0;
 		for (int i=0; i<8; i++) {
 			lines[i] = "";
 			colors[i] = FONT_WHITE;
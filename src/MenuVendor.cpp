@@ -23,6 +23,7 @@ MenuVendor::MenuVendor(SDL_Surface *_screen, FontEngine *_font, ItemDatabase *_i
 	stock.init( VENDOR_SLOTS, items, screen, font, slots_area, ICON_SIZE_32, 8);
 
 	visible = false;
+	panel_valid = false;
 	loadGraphics();
 	loadMerchant("");
 }
@@ -35,9 +36,9 @@ void MenuVendor::loadGraphics() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = background;
-	background = SDL_DisplayFormatAlpha(background);
-	SDL_FreeSurface(cleanup);	
+	background = image_loader.optimize(background, "images/menus/vendor.png", false);
+	
+	panel = createPanel(background, 320, 416);
 }
 
 void MenuVendor::loadMerchant(string filename) {
@@ -47,7 +48,20 @@ void MenuVendor::logic() {
 }
 
 void MenuVendor::render() {
-	if (!visible) return;
+	if (!visible || !panel) return;
+	
+	if (stock.changed() || !panel_valid || npc->name != shown_name) refresh();
+	
+	SDL_Rect dest;
+	dest.x = 0;
+	dest.y = (VIEW_H - 416)/2;
+	fastBlit(panel, NULL, screen, &dest);
+}
+
+/**
+ * Redraw the cached window, in panel coordinates
+ */
+void MenuVendor::refresh() {
 	SDL_Rect src;
 	SDL_Rect dest;
 	
@@ -57,18 +71,21 @@ void MenuVendor::render() {
 	src.x = 0;
 	src.y = 0;
 	dest.x = 0;
-	dest.y = offset_y;
+	dest.y = 0;
 	src.w = dest.w = 320;
 	src.h = dest.h = 416;
-	SDL_BlitSurface(background, &src, screen, &dest);
+	blitPanelBackground(background, &src, panel, &dest);
 		
 	// text overlay
 	// TODO: translate()
-	font->render("Vendor", 160, offset_y+8, JUSTIFY_CENTER, screen, FONT_WHITE);
-	font->render(npc->name, 160, offset_y+24, JUSTIFY_CENTER, screen, FONT_WHITE);
+	font->render("Vendor", 160, 8, JUSTIFY_CENTER, panel, FONT_WHITE);
+	font->render(npc->name, 160, 24, JUSTIFY_CENTER, panel, FONT_WHITE);
 	
 	// show stock
-	stock.render();
+	stock.render(panel, 0, offset_y);
+	
+	shown_name = npc->name;
+	panel_valid = true;
 }
 
 /**
@@ -126,5 +143,6 @@ void MenuVendor::saveInventory() {
 
 MenuVendor::~MenuVendor() {
 	SDL_FreeSurface(background);
+	SDL_FreeSurface(panel);
 }
 
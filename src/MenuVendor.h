@@ -13,6 +13,7 @@
 #include "SDL_mixer.h"
 #include "InputState.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "FontEngine.h"
 #include "MenuItemStorage.h"
 #include "MenuTooltip.h"
@@ -31,7 +32,11 @@ private:
 	StatBlock *stats;
 
 	void loadGraphics();
+	void refresh();
 	SDL_Surface *background;
+	SDL_Surface *panel; // cached window, redrawn when the stock or the merchant change
+	bool panel_valid;
+	string shown_name;
 	MenuItemStorage stock; // items the vendor currently has in stock
 
 public:
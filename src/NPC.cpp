@@ -199,12 +199,8 @@ void NPC::loadGraphics(string filename_sprites, string filename_portrait) {
 			fprintf(stderr, "Couldn't load NPC sprites: %s\n", IMG_GetError());
 		}
 	
-		SDL_SetColorKey( sprites, SDL_SRCCOLORKEY, SDL_MapRGB(sprites->format, 255, 0, 255) );
-	
 		// optimize
-		SDL_Surface *cleanup = sprites;
-		sprites = SDL_DisplayFormatAlpha(sprites);
-		SDL_FreeSurface(cleanup);
+		sprites = image_loader.optimize(sprites, "images/npcs/" + filename_sprites + ".png", true);
 	}
 	if (filename_portrait != "") {
 		portrait = IMG_Load(("images/portraits/" + filename_portrait + ".png").c_str());
@@ -212,12 +208,8 @@ void NPC::loadGraphics(string filename_sprites, string filename_portrait) {
 			fprintf(stderr, "Couldn't load NPC portrait: %s\n", IMG_GetError());
 		}
 	
-		SDL_SetColorKey( portrait, SDL_SRCCOLORKEY, SDL_MapRGB(portrait->format, 255, 0, 255) );
-	
 		// optimize
-		SDL_Surface *cleanup = portrait;
-		portrait = SDL_DisplayFormatAlpha(portrait);
-		SDL_FreeSurface(cleanup);
+		portrait = image_loader.optimize(portrait, "images/portraits/" + filename_portrait + ".png", true);
 	}
 	
 }
@@ -276,6 +268,7 @@ Renderable NPC::getRender() {
 	r.offset.x = render_offset.x;
 	r.offset.y = render_offset.y;
 	r.object_layer = true;
+	r.flip = false;
 		
 	return r;	
 }
@@ -14,6 +14,7 @@
 #include <string>
 #include <fstream>
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "UtilsParsing.h"
 #include "ItemDatabase.h"
 #include "ItemStorage.h"
@@ -17,6 +17,7 @@ PowerManager::PowerManager() {
 	sfx_count = 0;
 	for (int i=0; i<POWER_MAX_GFX; i++) {
 		gfx[i] = NULL;
+		atlases[i] = NULL;
 	}
 	for (int i=0; i<POWER_MAX_SFX; i++) {
 		sfx[i] = NULL;
@@ -43,6 +44,7 @@ PowerManager::PowerManager() {
 	loadGraphics();
 	loadSounds();
 	loadPowers();
+	packGFX();
 }
 
 /**
@@ -318,17 +320,55 @@ int PowerManager::loadGFX(string filename) {
 		return -1;
 	}
 	
-	// optimize
-	SDL_Surface *cleanup = gfx[gfx_count];
-	gfx[gfx_count] = SDL_DisplayFormatAlpha(gfx[gfx_count]);
-	SDL_FreeSurface(cleanup);	
-
 	// success; perform record-keeping
 	gfx_filenames[gfx_count] = filename;
 	gfx_count++;
 	return gfx_count-1;
 }
 
+/**
+ * Hazard sheets are trimmed and packed once every power is loaded, since a
+ * power's frame size can follow its gfx line. A sheet is only packed if
+ * every power drawing it agrees on the frame size; the shield sheet is
+ * drawn from its own rects, so it stays as it is.
+ */
+void PowerManager::packGFX() {
+	for (int i=0; i<gfx_count; i++) {
+		atlases[i] = NULL;
+		
+		Point frame_size;
+		frame_size.x = frame_size.y = -1;
+		bool packable = (i != powers[POWER_SHIELD].gfx_index);
+		
+		for (int j=0; j<POWER_COUNT && packable; j++) {
+			if (powers[j].gfx_index != i) continue;
+			
+			// hazards default to 64x64 frames
+			Point size = powers[j].frame_size;
+			if (size.x == 0) size.x = 64;
+			if (size.y == 0) size.y = 64;
+			
+			if (frame_size.x == -1) frame_size = size;
+			else if (size.x != frame_size.x || size.y != frame_size.y) packable = false;
+		}
+		
+		if (packable && frame_size.x != -1) {
+			atlases[i] = new SpriteAtlas();
+			if (atlases[i]->pack(gfx[i], frame_size.x, frame_size.y, "images/powers/" + gfx_filenames[i])) {
+				gfx[i] = atlases[i]->surface;
+			}
+			else {
+				delete atlases[i];
+				atlases[i] = NULL;
+				gfx[i] = NULL;
+			}
+		}
+		else {
+			gfx[i] = image_loader.optimize(gfx[i], "images/powers/" + gfx_filenames[i], false);
+		}
+	}
+}
+
 /**
  * Load the specified sound effect for this power
  *
@@ -419,6 +459,17 @@ int PowerManager::calcDirection(int origin_x, int origin_y, int target_x, int ta
 }
 
 
+/**
+ * A fresh hazard from the pool, already queued for HazardManager.
+ * Returns NULL if the pool is exhausted.
+ */
+Hazard *PowerManager::newHazard() {
+	int handle = hazard_pool.alloc();
+	if (handle == -1) return NULL;
+	hazards.push(handle);
+	return hazard_pool.get(handle);
+}
+
 /**
  * Apply basic power info to a new hazard.
  *
@@ -464,6 +515,7 @@ void PowerManager::initHazard(int power_index, StatBlock *src_stats, Point targe
 	
 	if (powers[power_index].gfx_index != -1) {
 		haz->sprites = gfx[powers[power_index].gfx_index];
+		haz->atlas = atlases[powers[power_index].gfx_index];
 	}
 	if (powers[power_index].rendered) {
 		haz->rendered = powers[power_index].rendered;
@@ -645,22 +697,22 @@ void PowerManager::playSound(int power_index, StatBlock *src_stats) {
 	if (powers[power_index].allow_power_mod) {
 		if (powers[power_index].base_damage == BASE_DAMAGE_MELEE && src_stats->melee_weapon_power != -1 
 				&& powers[src_stats->melee_weapon_power].sfx_index != -1) {
-			Mix_PlayChannel(-1,sfx[powers[src_stats->melee_weapon_power].sfx_index],0);
+			sound_queue.play(sfx[powers[src_stats->melee_weapon_power].sfx_index]);
 		}
 		else if (powers[power_index].base_damage == BASE_DAMAGE_MENT && src_stats->mental_weapon_power != -1 
 				&& powers[src_stats->mental_weapon_power].sfx_index != -1) {
-			Mix_PlayChannel(-1,sfx[powers[src_stats->mental_weapon_power].sfx_index],0);
+			sound_queue.play(sfx[powers[src_stats->mental_weapon_power].sfx_index]);
 		}
 		else if (powers[power_index].base_damage == BASE_DAMAGE_RANGED && src_stats->ranged_weapon_power != -1 
 				&& powers[src_stats->ranged_weapon_power].sfx_index != -1) {
-			Mix_PlayChannel(-1,sfx[powers[src_stats->ranged_weapon_power].sfx_index],0);
+			sound_queue.play(sfx[powers[src_stats->ranged_weapon_power].sfx_index]);
 		}
 		else play_base_sound = true;
 	}
 	else play_base_sound = true;
 
 	if (play_base_sound && powers[power_index].sfx_index != -1) {
-		Mix_PlayChannel(-1,sfx[powers[power_index].sfx_index],0);
+		sound_queue.play(sfx[powers[power_index].sfx_index]);
 	}
 		
 }
@@ -677,11 +729,8 @@ void PowerManager::playSound(int power_index, StatBlock *src_stats) {
 bool PowerManager::effect(int power_index, StatBlock *src_stats, Point target) {
 
 	if (powers[power_index].use_hazard) {
-		Hazard *haz = new Hazard();
-		initHazard(power_index, src_stats, target, haz);
-		
-		// Hazard memory is now the responsibility of HazardManager
-		hazards.push(haz);
+		Hazard *haz = newHazard();
+		if (haz != NULL) initHazard(power_index, src_stats, target, haz);
 	}
 
 	buff(power_index, src_stats, target);
@@ -711,7 +760,8 @@ bool PowerManager::effect(int power_index, StatBlock *src_stats, Point target) {
 bool PowerManager::missile(int power_index, StatBlock *src_stats, Point target) {
 
 	int missile_speed;
-	Hazard *haz = new Hazard();
+	Hazard *haz = newHazard();
+	if (haz == NULL) return false;
 	initHazard(power_index, src_stats, target, haz);
 	missile_speed = haz->base_speed;
 	
@@ -730,9 +780,6 @@ bool PowerManager::missile(int power_index, StatBlock *src_stats, Point target)
 		haz->speed.x *= -1.0;
 	if (dy > 0.0 && haz->speed.y < 0.0 || dy < 0.0 && haz->speed.y > 0.0)
 		haz->speed.y *= -1.0;
-	
-	// Hazard memory is now the responsibility of HazardManager
-	hazards.push(haz);
 
 	// if all else succeeded, pay costs
 	if (powers[power_index].requires_mp) {
@@ -751,7 +798,8 @@ bool PowerManager::missileX3(int power_index, StatBlock *src_stats, Point target
 	Hazard *haz[3];
 
 	for (int i=0; i<3; i++) {
-		haz[i] = new Hazard();		
+		haz[i] = newHazard();
+		if (haz[i] == NULL) return false;
 		initHazard(power_index, src_stats, target, haz[i]);
 	}
 	playSound(power_index, src_stats);
@@ -778,7 +826,6 @@ bool PowerManager::missileX3(int power_index, StatBlock *src_stats, Point target
 		haz[0]->speed.x *= -1.0;
 	if (dy > 0.0 && haz[0]->speed.y < 0.0 || dy < 0.0 && haz[0]->speed.y > 0.0)
 		haz[0]->speed.y *= -1.0;
-	hazards.push(haz[0]);
 	
 	// side missile
 	haz[1]->speed.x = (float)missile_speed * cos(theta + (float)angle);
@@ -787,7 +834,6 @@ bool PowerManager::missileX3(int power_index, StatBlock *src_stats, Point target
 		haz[1]->speed.x *= -1.0;
 	if (dy > 0.0 && haz[1]->speed.y < 0.0 || dy < 0.0 && haz[1]->speed.y > 0.0)
 		haz[1]->speed.y *= -1.0;
-	hazards.push(haz[1]);	
 
 	// side missile
 	haz[2]->speed.x = (float)missile_speed * cos(theta - (float)angle);
@@ -796,9 +842,7 @@ bool PowerManager::missileX3(int power_index, StatBlock *src_stats, Point target
 		haz[2]->speed.x *= -1.0;
 	if (dy > 0.0 && haz[2]->speed.y < 0.0 || dy < 0.0 && haz[2]->speed.y > 0.0)
 		haz[2]->speed.y *= -1.0;
-	hazards.push(haz[2]);	
 	
-	// Hazard memory is now the responsibility of HazardManager
 	return true;
 }
 
@@ -834,7 +878,7 @@ bool PowerManager::groundRay(int power_index, StatBlock *src_stats, Point target
 	delay_iterator = 0;
 
 	if (power_index == POWER_FREEZE) {
-		Mix_PlayChannel(-1, sfx_freeze, 0);
+		sound_queue.play(sfx_freeze);
 	}
 
 	for (int i=0; i<10; i++) {
@@ -847,7 +891,8 @@ bool PowerManager::groundRay(int power_index, StatBlock *src_stats, Point target
 			break; // no more hazards
 		}
 
-		haz[i] = new Hazard();	
+		haz[i] = newHazard();
+		if (haz[i] == NULL) break;
 		haz[i]->pos.x = location_iterator.x;
 		haz[i]->pos.y = location_iterator.y;
 		
@@ -880,11 +925,8 @@ bool PowerManager::groundRay(int power_index, StatBlock *src_stats, Point target
 			haz[i]->slow_duration = 90;
 			haz[i]->trait_elemental = ELEMENT_WATER;
 		}
-		
-		hazards.push(haz[i]);
 	}
 	
-	// Hazard memory is now the responsibility of HazardManager
 	return true;
 }
 
@@ -894,7 +936,8 @@ bool PowerManager::groundRay(int power_index, StatBlock *src_stats, Point target
  */
 bool PowerManager::single(int power_index, StatBlock *src_stats, Point target) {
 	
-	Hazard *haz = new Hazard();
+	Hazard *haz = newHazard();
+	if (haz == NULL) return false;
 	
 	// common to all singles
 	haz->pos.x = (float)target.x;
@@ -921,9 +964,6 @@ bool PowerManager::single(int power_index, StatBlock *src_stats, Point target) {
 		src_stats->vengeance_stacks = 0;
 	}
 	
-	hazards.push(haz);
-
-	// Hazard memory is now the responsibility of HazardManager
 	return true;
 }
 
@@ -952,7 +992,9 @@ bool PowerManager::activate(int power_index, StatBlock *src_stats, Point target)
 PowerManager::~PowerManager() {
 
 	for (int i=0; i<gfx_count; i++) {
-		if (gfx[i] != NULL)
+		if (atlases[i] != NULL)
+			delete atlases[i];
+		else if (gfx[i] != NULL)
 			SDL_FreeSurface(gfx[i]);
 	}
 	for (int i=0; i<sfx_count; i++) {
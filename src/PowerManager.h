@@ -13,9 +13,12 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
+#include "SpriteAtlas.h"
 #include "StatBlock.h"
 #include "Hazard.h"
+#include "HazardPool.h"
 #include "MapCollision.h"
+#include "SoundQueue.h"
 
 #ifndef POWER_MANAGER_H
 #define POWER_MANAGER_H
@@ -216,6 +219,7 @@ private:
 	void loadSounds();
 	
 	int loadGFX(string filename);
+	void packGFX();
 	int loadSFX(string filename);
 	string gfx_filenames[POWER_MAX_GFX];
 	string sfx_filenames[POWER_MAX_SFX];
@@ -224,6 +228,7 @@ private:
 
 
 	int calcDirection(int origin_x, int origin_y, int target_x, int target_y);
+	Hazard *newHazard();
 	void initHazard(int powernum, StatBlock *src_stats, Point target, Hazard *haz);
 	void buff(int power_index, StatBlock *src_stats, Point target);
 	void playSound(int power_index, StatBlock *src_stats);
@@ -243,10 +248,12 @@ public:
 	bool activate(int power_index, StatBlock *src_stats, Point target);
 		
 	Power powers[POWER_COUNT];
-	queue<Hazard *> hazards; // output; read by HazardManager
+	HazardPool hazard_pool;
+	queue<int> hazards; // output: handles of new hazards; read by HazardManager
 
 	// shared images/sounds for power special effects
 	SDL_Surface *gfx[POWER_MAX_GFX];
+	SpriteAtlas *atlases[POWER_MAX_GFX]; // owns gfx[i] when set
 	Mix_Chunk *sfx[POWER_MAX_SFX];
 	
 	SDL_Surface *freeze;
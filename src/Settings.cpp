@@ -31,11 +31,15 @@ int VIEW_W_HALF = VIEW_W/2;
 int VIEW_H_HALF = VIEW_H/2;
 bool DOUBLEBUF = false;
 bool HWSURFACE = false;
+bool SHOW_FPS = false;
+int MINIMAP_ZOOM = 1; // pixels per tile
+bool MINIMAP_FOG = false;
 
 // Audio Settings
 int MUSIC_VOLUME = 64;
 int SOUND_VOLUME = 64;
 bool MENUS_PAUSE = false;
+int WORKER_THREADS = -1; // one per spare core
 
 // Input Settings
 bool MOUSE_MOVE = false;
@@ -97,6 +101,19 @@ bool loadSettings() {
 					else if (key == "doublebuf") {
 						if (val == "1") DOUBLEBUF = true;
 					}
+					else if (key == "show_fps") {
+						if (val == "1") SHOW_FPS = true;
+					}
+					else if (key == "minimap_zoom") {
+						MINIMAP_ZOOM = atoi(val.c_str());
+						if (MINIMAP_ZOOM < 1) MINIMAP_ZOOM = 1;
+					}
+					else if (key == "minimap_fog") {
+						if (val == "1") MINIMAP_FOG = true;
+					}
+					else if (key == "threads") {
+						WORKER_THREADS = atoi(val.c_str());
+					}
 				}
 			}
 		}
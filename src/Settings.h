@@ -19,12 +19,16 @@ extern int VIEW_W_HALF;
 extern int VIEW_H_HALF;
 extern bool DOUBLEBUF;
 extern bool HWSURFACE;
+extern bool SHOW_FPS;
+extern int MINIMAP_ZOOM;
+extern bool MINIMAP_FOG;
 
 // Input Settings
 extern bool MOUSE_MOVE;
 
 // Engine Settings
 extern bool MENUS_PAUSE;
+extern int WORKER_THREADS;
 
 // Tile Settings
 extern int UNITS_PER_TILE;
@@ -0,0 +1,51 @@
+/**
+ * class SoundQueue
+ *
+ * Sound effects requested by the world tick. The tick can run on a worker
+ * while the main thread renders, so while the queue is held, play() only
+ * records the chunk; GameEngine releases the queue once the tick is done.
+ *
+ * @license GPL
+ */
+
+#include "SoundQueue.h"
+
+SoundQueue sound_queue;
+
+SoundQueue::SoundQueue() {
+	count = 0;
+	holding = false;
+}
+
+/**
+ * Play chunk now, or after release() if the queue is held.
+ * A full queue drops the sound.
+ */
+void SoundQueue::play(Mix_Chunk *chunk) {
+	if (!chunk) return;
+	
+	if (!holding) {
+		Mix_PlayChannel(-1, chunk, 0);
+		return;
+	}
+	
+	if (count < SOUND_QUEUE_SIZE) queued[count++] = chunk;
+}
+
+/**
+ * Hold sounds from here on. Called just before the world tick starts.
+ */
+void SoundQueue::hold() {
+	holding = true;
+}
+
+/**
+ * Play every held sound, on the main thread, and stop holding
+ */
+void SoundQueue::release() {
+	holding = false;
+	for (int i=0; i<count; i++) {
+		Mix_PlayChannel(-1, queued[i], 0);
+	}
+	count = 0;
+}
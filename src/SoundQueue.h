@@ -0,0 +1,33 @@
+/**
+ * class SoundQueue
+ *
+ * Sound effects requested by the world tick. The tick can run on a worker
+ * while the main thread renders, so while the queue is held, play() only
+ * records the chunk; GameEngine releases the queue once the tick is done.
+ *
+ * @license GPL
+ */
+
+#ifndef SOUND_QUEUE_H
+#define SOUND_QUEUE_H
+
+#include "SDL_mixer.h"
+
+const int SOUND_QUEUE_SIZE = 64;
+
+class SoundQueue {
+private:
+	Mix_Chunk *queued[SOUND_QUEUE_SIZE];
+	int count;
+	bool holding;
+
+public:
+	SoundQueue();
+	void play(Mix_Chunk *chunk);
+	void hold();
+	void release();
+};
+
+extern SoundQueue sound_queue;
+
+#endif
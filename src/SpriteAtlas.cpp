@@ -0,0 +1,373 @@
+/**
+ * class SpriteAtlas
+ *
+ * A sprite sheet laid out on a fixed grid, repacked at load time.
+ *
+ * @license GPL
+ */
+
+#include "SpriteAtlas.h"
+#include <algorithm>
+
+struct PackItem {
+	int index;
+	int h;
+};
+
+static bool tallerFirst(const PackItem &a, const PackItem &b) {
+	if (a.h != b.h) return a.h > b.h;
+	return a.index < b.index;
+}
+
+SpriteAtlas::SpriteAtlas() {
+	frames = NULL;
+	surface = NULL;
+	cell_w = cell_h = 0;
+	columns = rows = 0;
+	sheet_pixels = atlas_pixels = 0;
+	for (int i=0; i<ATLAS_MAX_ROWS; i++) mirror_of[i] = -1;
+}
+
+/**
+ * Draw row as source_row mirrored. Must be set before packing.
+ * Returns false if either row is out of range or already a mirror.
+ */
+bool SpriteAtlas::mirror(int row, int source_row) {
+	if (row < 0 || row >= ATLAS_MAX_ROWS || source_row < 0 || source_row >= ATLAS_MAX_ROWS) return false;
+	if (row == source_row || mirror_of[source_row] != -1) return false;
+	for (int i=0; i<ATLAS_MAX_ROWS; i++) {
+		if (mirror_of[i] == row) return false;
+	}
+	mirror_of[row] = source_row;
+	return true;
+}
+
+int SpriteAtlas::mirrored(int row) {
+	if (row < ATLAS_MAX_ROWS) return mirror_of[row];
+	return -1;
+}
+
+/**
+ * Trim and pack sheet, freeing it, into a new 32-bit alpha surface.
+ * Its colorkey, if set, counts as transparent.
+ * Returns NULL if SDL can't convert the sheet.
+ */
+SDL_Surface *SpriteAtlas::layout(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name) {
+	if (!sheet) return NULL;
+	
+	SDL_Surface *argb = SDL_DisplayFormatAlpha(sheet);
+	SDL_FreeSurface(sheet);
+	if (!argb) {
+		fprintf(stderr, "Couldn't convert sprite sheet %s: %s\n", name.c_str(), SDL_GetError());
+		return NULL;
+	}
+	
+	cell_w = _cell_w > 0 ? _cell_w : argb->w;
+	cell_h = _cell_h > 0 ? _cell_h : argb->h;
+	columns = (argb->w + cell_w - 1) / cell_w;
+	rows = (argb->h + cell_h - 1) / cell_h;
+	sheet_pixels = argb->w * argb->h;
+	
+	// mirrored rows may be missing from the bottom of the sheet
+	for (int i=0; i<ATLAS_MAX_ROWS; i++) {
+		if (mirror_of[i] == -1) continue;
+		if (i >= rows) rows = i+1;
+		if (mirror_of[i] >= rows) rows = mirror_of[i]+1;
+	}
+	
+	delete[] frames;
+	frames = new AtlasFrame[columns * rows];
+	
+	if (SDL_MUSTLOCK(argb)) SDL_LockSurface(argb);
+	Uint32 amask = argb->format->Amask;
+	
+	// trim every cell to the bounding box of its visible pixels
+	for (int row=0; row<rows; row++) {
+		for (int col=0; col<columns; col++) {
+			int x0 = col * cell_w;
+			int y0 = row * cell_h;
+			int x1 = x0 + cell_w;
+			int y1 = y0 + cell_h;
+			if (x1 > argb->w) x1 = argb->w;
+			if (y1 > argb->h) y1 = argb->h;
+			
+			int left = x1, right = x0, top = y1, bottom = y0;
+			if (mirrored(row) != -1) y1 = y0;
+			for (int y=y0; y<y1; y++) {
+				Uint32 *p = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+				for (int x=x0; x<x1; x++) {
+					if (p[x] & amask) {
+						if (x < left) left = x;
+						if (x >= right) right = x+1;
+						if (y < top) top = y;
+						bottom = y+1;
+					}
+				}
+			}
+			
+			AtlasFrame *f = &frames[row * columns + col];
+			f->flip = false;
+			if (left >= right) {
+				f->src.x = f->src.y = 0;
+				f->src.w = f->src.h = 0;
+				f->trim.x = f->trim.y = 0;
+			}
+			else {
+				f->src.x = left; // sheet position until packed
+				f->src.y = top;
+				f->src.w = right - left;
+				f->src.h = bottom - top;
+				f->trim.x = left - x0;
+				f->trim.y = top - y0;
+			}
+		}
+	}
+	
+	// shelf pack, tallest first, no wider than the sheet
+	int count = columns * rows;
+	PackItem *order = new PackItem[count];
+	for (int i=0; i<count; i++) {
+		order[i].index = i;
+		order[i].h = frames[i].src.h;
+	}
+	std::sort(order, order + count, tallerFirst);
+	
+	Point *place = new Point[count];
+	int atlas_w = argb->w;
+	int shelf_x = 0, shelf_y = 0, shelf_h = 0;
+	for (int i=0; i<count; i++) {
+		AtlasFrame *f = &frames[order[i].index];
+		if (f->src.w == 0) continue;
+		if (shelf_x + f->src.w > atlas_w) {
+			shelf_y += shelf_h;
+			shelf_x = 0;
+			shelf_h = 0;
+		}
+		if (shelf_h == 0) shelf_h = f->src.h;
+		place[order[i].index].x = shelf_x;
+		place[order[i].index].y = shelf_y;
+		shelf_x += f->src.w;
+	}
+	int atlas_h = shelf_y + shelf_h;
+	delete[] order;
+	
+	// an all clear sheet still gets a surface to point at
+	if (atlas_h == 0) atlas_h = 1;
+	
+	SDL_PixelFormat *fmt = argb->format;
+	SDL_Surface *atlas = SDL_CreateRGBSurface(SDL_SWSURFACE, atlas_w, atlas_h, 32, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if (!atlas) {
+		fprintf(stderr, "Couldn't create sprite atlas %s: %s\n", name.c_str(), SDL_GetError());
+		if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+		SDL_FreeSurface(argb);
+		delete[] place;
+		return NULL;
+	}
+	SDL_FillRect(atlas, NULL, 0);
+	
+	for (int i=0; i<count; i++) {
+		AtlasFrame *f = &frames[i];
+		if (f->src.w == 0) continue;
+		for (int y=0; y<f->src.h; y++) {
+			Uint32 *from = (Uint32 *)((Uint8 *)argb->pixels + (f->src.y + y) * argb->pitch) + f->src.x;
+			Uint32 *to = (Uint32 *)((Uint8 *)atlas->pixels + (place[i].y + y) * atlas->pitch) + place[i].x;
+			memcpy(to, from, f->src.w * 4);
+		}
+		f->src.x = place[i].x;
+		f->src.y = place[i].y;
+	}
+	delete[] place;
+	
+	// mirrored rows reuse their source row's frames, flipped within the cell
+	for (int row=0; row<rows; row++) {
+		if (mirrored(row) == -1) continue;
+		for (int col=0; col<columns; col++) {
+			AtlasFrame *f = &frames[row * columns + col];
+			*f = frames[mirrored(row) * columns + col];
+			if (f->src.w > 0) f->trim.x = cell_w - f->trim.x - f->src.w;
+			f->flip = true;
+		}
+	}
+	
+	if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+	SDL_FreeSurface(argb);
+	
+	SDL_SetAlpha(atlas, SDL_SRCALPHA, 255);
+	atlas_pixels = atlas_w * atlas_h;
+	return atlas;
+}
+
+/**
+ * Repack sheet, taking ownership of it. Its colorkey, if set, counts as
+ * transparent. The packed surface goes through the image loader, so it
+ * still ends up in the cheapest display format.
+ * Returns false, with no surface, if SDL can't convert the sheet.
+ */
+bool SpriteAtlas::pack(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name) {
+	SDL_Surface *atlas = layout(sheet, _cell_w, _cell_h, name);
+	if (!atlas) return false;
+	surface = image_loader.optimize(atlas, name, false);
+	return surface != NULL;
+}
+
+/**
+ * Same as pack(), but the packed surface is reduced to an 8-bit palette.
+ * Sheets with partial transparency keep per-pixel alpha.
+ */
+bool SpriteAtlas::packIndexed(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name) {
+	SDL_Surface *atlas = layout(sheet, _cell_w, _cell_h, name);
+	if (!atlas) return false;
+	surface = image_loader.quantize(atlas, name);
+	return surface != NULL;
+}
+
+/**
+ * Take sheet, a recolor of the sheet base was packed from, as a new
+ * palette over base's frames and pixels. Each palette entry becomes the
+ * average color sheet has where base used that entry.
+ * Falls back to packing sheet on its own if base isn't indexed or the
+ * two sheets don't have the same shape. base must outlive this atlas.
+ */
+bool SpriteAtlas::recolor(SpriteAtlas *base, SDL_Surface *sheet, const string &name) {
+	if (!sheet) return false;
+	
+	SDL_Surface *indexed = base->surface;
+	if (!indexed || indexed->format->BytesPerPixel != 1 ||
+	    (sheet->w + base->cell_w - 1) / base->cell_w != base->columns ||
+	    (sheet->h + base->cell_h - 1) / base->cell_h > base->rows) {
+		return packIndexed(sheet, base->cell_w, base->cell_h, name);
+	}
+	
+	SDL_Surface *argb = SDL_DisplayFormatAlpha(sheet);
+	if (!argb) {
+		fprintf(stderr, "Couldn't convert sprite sheet %s: %s\n", name.c_str(), SDL_GetError());
+		SDL_FreeSurface(sheet);
+		return false;
+	}
+	
+	double sum_r[IMAGE_PALETTE_SIZE];
+	double sum_g[IMAGE_PALETTE_SIZE];
+	double sum_b[IMAGE_PALETTE_SIZE];
+	int samples[IMAGE_PALETTE_SIZE];
+	for (int i=0; i<IMAGE_PALETTE_SIZE; i++) {
+		sum_r[i] = sum_g[i] = sum_b[i] = 0;
+		samples[i] = 0;
+	}
+	
+	if (SDL_MUSTLOCK(argb)) SDL_LockSurface(argb);
+	if (SDL_MUSTLOCK(indexed)) SDL_LockSurface(indexed);
+	SDL_PixelFormat *fmt = argb->format;
+	
+	// sample sheet under every visible pixel of base
+	int base_visible = 0;
+	int shared = 0;
+	for (int i=0; i<base->columns * base->rows; i++) {
+		AtlasFrame *f = &base->frames[i];
+		if (f->flip) continue;
+		int sheet_x = (i % base->columns) * base->cell_w + f->trim.x;
+		int sheet_y = (i / base->columns) * base->cell_h + f->trim.y;
+		for (int y=0; y<f->src.h; y++) {
+			Uint8 *from = (Uint8 *)indexed->pixels + (f->src.y + y) * indexed->pitch + f->src.x;
+			Uint32 *over = NULL;
+			if (sheet_y + y < argb->h) over = (Uint32 *)((Uint8 *)argb->pixels + (sheet_y + y) * argb->pitch) + sheet_x;
+			for (int x=0; x<f->src.w; x++) {
+				if (from[x] == 0) continue;
+				base_visible++;
+				if (!over || sheet_x + x >= argb->w) continue;
+				if ((over[x] & fmt->Amask) == 0) continue;
+				shared++;
+				sum_r[from[x]] += (over[x] & fmt->Rmask) >> fmt->Rshift;
+				sum_g[from[x]] += (over[x] & fmt->Gmask) >> fmt->Gshift;
+				sum_b[from[x]] += (over[x] & fmt->Bmask) >> fmt->Bshift;
+				samples[from[x]]++;
+			}
+		}
+	}
+	
+	int sheet_visible = 0;
+	for (int y=0; y<argb->h; y++) {
+		if (base->mirrored(y / base->cell_h) != -1) continue;
+		Uint32 *row = (Uint32 *)((Uint8 *)argb->pixels + y * argb->pitch);
+		for (int x=0; x<argb->w; x++) {
+			if (row[x] & fmt->Amask) sheet_visible++;
+		}
+	}
+	
+	if (SDL_MUSTLOCK(indexed)) SDL_UnlockSurface(indexed);
+	if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+	SDL_FreeSurface(argb);
+	
+	int mismatch = (base_visible - shared) + (sheet_visible - shared);
+	if (mismatch * ATLAS_RECOLOR_MISMATCH > sheet_visible) {
+		fprintf(stderr, "Sprite sheet %s is not a recolor of its base, packing it separately\n", name.c_str());
+		return packIndexed(sheet, base->cell_w, base->cell_h, name);
+	}
+	SDL_FreeSurface(sheet);
+	
+	// entries sheet never covers keep the base color
+	SDL_Color colors[IMAGE_PALETTE_SIZE];
+	for (int i=0; i<IMAGE_PALETTE_SIZE; i++) {
+		colors[i] = indexed->format->palette->colors[i];
+		if (i == 0 || samples[i] == 0) continue;
+		colors[i].r = (Uint8)(sum_r[i] / samples[i] + 0.5);
+		colors[i].g = (Uint8)(sum_g[i] / samples[i] + 0.5);
+		colors[i].b = (Uint8)(sum_b[i] / samples[i] + 0.5);
+	}
+	
+	surface = SDL_CreateRGBSurfaceFrom(indexed->pixels, indexed->w, indexed->h, 8, indexed->pitch, 0, 0, 0, 0);
+	if (!surface) {
+		fprintf(stderr, "Couldn't create sprite recolor %s: %s\n", name.c_str(), SDL_GetError());
+		return false;
+	}
+	SDL_SetColors(surface, colors, 0, IMAGE_PALETTE_SIZE);
+	if (indexed->flags & SDL_SRCCOLORKEY) SDL_SetColorKey(surface, SDL_SRCCOLORKEY, 0);
+	
+	cell_w = base->cell_w;
+	cell_h = base->cell_h;
+	columns = base->columns;
+	rows = base->rows;
+	sheet_pixels = base->sheet_pixels;
+	atlas_pixels = 0;
+	delete[] frames;
+	frames = new AtlasFrame[columns * rows];
+	for (int i=0; i<columns * rows; i++) frames[i] = base->frames[i];
+	for (int i=0; i<ATLAS_MAX_ROWS; i++) mirror_of[i] = base->mirror_of[i];
+	return true;
+}
+
+/**
+ * The frame for a grid cell, or NULL outside the grid
+ */
+AtlasFrame *SpriteAtlas::frame(int column, int row) {
+	if (column < 0 || row < 0 || column >= columns || row >= rows) return NULL;
+	return &frames[row * columns + column];
+}
+
+/**
+ * Point a renderable built against the grid at the packed frame instead,
+ * flipped if its row is a mirror.
+ * A src that isn't exactly one cell has no packed frame and draws nothing.
+ */
+void SpriteAtlas::lookup(Renderable &r) {
+	r.sprite = surface;
+	r.flip = false;
+	
+	AtlasFrame *f = NULL;
+	if (r.src.w == cell_w && r.src.h == cell_h && r.src.x % cell_w == 0 && r.src.y % cell_h == 0)
+		f = frame(r.src.x / cell_w, r.src.y / cell_h);
+	
+	if (!f) {
+		r.src.w = r.src.h = 0;
+		return;
+	}
+	
+	r.src = f->src;
+	r.flip = f->flip;
+	r.offset.x -= f->trim.x;
+	r.offset.y -= f->trim.y;
+}
+
+SpriteAtlas::~SpriteAtlas() {
+	delete[] frames;
+	if (surface) SDL_FreeSurface(surface);
+}
@@ -0,0 +1,73 @@
+/**
+ * class SpriteAtlas
+ *
+ * A sprite sheet laid out on a fixed grid, repacked at load time.
+ * Each cell is trimmed to its visible pixels and the trimmed frames are
+ * shelf-packed into one smaller surface. The frame table maps a grid cell
+ * to its rect in the atlas and where that rect sat inside the cell.
+ *
+ * Renderables are still built against the grid; lookup() moves them
+ * onto the atlas, so nothing else needs to know the sheet was packed.
+ *
+ * An indexed atlas stores 8-bit palette pixels. A sheet that only
+ * recolors another can then be a recolor() of it: the same frames and
+ * pixels, read through its own palette.
+ *
+ * A row can also be marked as the mirror image of another. It then takes
+ * no atlas space, and may be left blank or missing in the sheet: its
+ * frames are the source row's, drawn flipped about the cell's center.
+ *
+ * @license GPL
+ */
+
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <string>
+#include "SDL.h"
+#include "Utils.h"
+#include "ImageLoader.h"
+
+using namespace std;
+
+const int ATLAS_MAX_ROWS = 16; // rows that can be mirrors
+
+// a recolor gives up if more than 1 in this many visible pixels differ in shape
+const int ATLAS_RECOLOR_MISMATCH = 100;
+
+struct AtlasFrame {
+	SDL_Rect src; // in the atlas; w = h = 0 for an empty cell
+	Point trim; // top left of src within its grid cell
+	bool flip; // src is drawn mirrored left to right
+};
+
+class SpriteAtlas {
+private:
+	AtlasFrame *frames;
+	int mirror_of[ATLAS_MAX_ROWS]; // row mirrored into each row, or -1
+	int mirrored(int row);
+	SDL_Surface *layout(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name);
+
+public:
+	SpriteAtlas();
+	~SpriteAtlas();
+	
+	bool mirror(int row, int source_row);
+	bool pack(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name);
+	bool packIndexed(SDL_Surface *sheet, int _cell_w, int _cell_h, const string &name);
+	bool recolor(SpriteAtlas *base, SDL_Surface *sheet, const string &name);
+	AtlasFrame *frame(int column, int row);
+	void lookup(Renderable &r);
+
+	SDL_Surface *surface;
+	int cell_w;
+	int cell_h;
+	int columns;
+	int rows;
+	
+	// statistics
+	int sheet_pixels; // area of the grid sheet
+	int atlas_pixels; // area of the packed surface, 0 for a recolor
+};
+
+#endif
@@ -57,6 +57,9 @@ StatBlock::StatBlock() {
 	cooldown_ticks = 0;
 	blocking = false;
 	
+	// every direction has its own row in the sprite sheet
+	for (int i=0; i<8; i++) render_mirror[i] = -1;
+	
 	// xp table
 	// what experience do you need to reach the next level
 	// formula:
@@ -149,6 +152,7 @@ void StatBlock::load(string filename) {
 					if (key == "name") name = val;
 					else if (key == "sfx_prefix") sfx_prefix = val;
 					else if (key == "gfx_prefix") gfx_prefix = val;
+					else if (key == "gfx_base") gfx_base = val;
 					
 					else if (key == "level") level = num;
 					
@@ -215,6 +219,12 @@ void StatBlock::load(string filename) {
 					else if (key == "render_size_y") render_size.y = num;
 					else if (key == "render_offset_x") render_offset.x = num;
 					else if (key == "render_offset_y") render_offset.y = num;
+					else if (key == "render_mirror") {
+						int dir = eatFirstInt(val, ',');
+						int source_dir = eatFirstInt(val, ',');
+						if (dir >= 0 && dir < 8 && source_dir >= 0 && source_dir < 8)
+							render_mirror[dir] = source_dir;
+					}
 					else if (key == "anim_stance_position") anim_stance_position = num; 
 					else if (key == "anim_stance_frames") anim_stance_frames = num;
 					else if (key == "anim_stance_duration")anim_stance_duration = num;
@@ -397,6 +407,82 @@ void StatBlock::logic() {
 
 }
 
+/**
+ * Count down a timer by up to ticks, stopping at zero
+ */
+static int countDown(int value, int ticks) {
+	if (value > ticks) return value - ticks;
+	return 0;
+}
+
+/**
+ * How many of the values lo..hi land on a once-per-second pulse (x % FRAMES_PER_SEC == 1)
+ */
+static int countPulses(int lo, int hi) {
+	if (hi < 1 || hi < lo) return 0;
+	int below = 0;
+	if (lo > 1) below = (lo - 2) / FRAMES_PER_SEC + 1;
+	return (hi - 1) / FRAMES_PER_SEC + 1 - below;
+}
+
+/**
+ * Catch up on ticks skipped while the AI scheduler let this creature sleep.
+ * Timers end up where ticks calls to logic() would leave them. Regen, bleed and
+ * heal-over-time are applied as one batch, so hp may differ by a point or two
+ * when it touches maxhp part way through.
+ */
+void StatBlock::advance(int ticks) {
+	if (ticks <= 0) return;
+
+	cooldown_ticks = countDown(cooldown_ticks, ticks);
+	for (int i=0; i<POWERSLOT_COUNT; i++) {
+		power_ticks[i] = countDown(power_ticks[i], ticks);
+	}
+
+	// HP/MP regen
+	if (hp_per_minute > 0 && hp < maxhp && hp > 0) {
+		hp_ticker += ticks;
+		int period = (60 * FRAMES_PER_SEC)/hp_per_minute;
+		if (period < 1) period = 1;
+		hp += hp_ticker / period;
+		hp_ticker = hp_ticker % period;
+		if (hp > maxhp) hp = maxhp;
+	}
+	if (mp_per_minute > 0 && mp < maxmp && hp > 0) {
+		mp_ticker += ticks;
+		int period = (60 * FRAMES_PER_SEC)/mp_per_minute;
+		if (period < 1) period = 1;
+		mp += mp_ticker / period;
+		mp_ticker = mp_ticker % period;
+		if (mp > maxmp) mp = maxmp;
+	}
+
+	// bleed and healing over time pulse as their durations pass through each second
+	int bleed_end = countDown(bleed_duration, ticks);
+	int bleed_pulses = countPulses(bleed_end, bleed_duration-1);
+	int hot_end = countDown(hot_duration, ticks);
+	int hot_pulses = countPulses(hot_end, hot_duration-1);
+
+	slow_duration = countDown(slow_duration, ticks);
+	bleed_duration = bleed_end;
+	stun_duration = countDown(stun_duration, ticks);
+	immobilize_duration = countDown(immobilize_duration, ticks);
+	immunity_duration = countDown(immunity_duration, ticks);
+	haste_duration = countDown(haste_duration, ticks);
+	hot_duration = hot_end;
+
+	if (bleed_pulses > 0) takeDamage(bleed_pulses);
+	if (hot_pulses > 0) {
+		hp += hot_value * hot_pulses;
+		if (hp > maxhp) hp = maxhp;
+	}
+
+	targeted = countDown(targeted, ticks);
+
+	shield_frame = (shield_frame + ticks) % 12;
+	vengeance_frame = (vengeance_frame + ticks * vengeance_stacks) % 24;
+}
+
 /**
  * Remove temporary buffs/debuffs
  */
@@ -419,6 +505,7 @@ Renderable StatBlock::getEffectRender(int effect_type) {
 	Renderable r;
 	r.map_pos.x = pos.x;
 	r.map_pos.y = pos.y;
+	r.flip = false;
 	
 	if (effect_type == STAT_EFFECT_SHIELD) {
 		r.src.x = (shield_frame/3) * 128;
@@ -38,6 +38,7 @@ public:
 	void takeDamage(int dmg);
 	void recalc();
 	void logic();
+	void advance(int ticks);
 	void clearEffects();
 	Renderable getEffectRender(int effect_type);
 
@@ -49,6 +50,7 @@ public:
 	string name;
 	string sfx_prefix;
 	string gfx_prefix;
+	string gfx_base; // gfx_prefix is a recolor of this sheet
 	
 	int level;
 	int xp;
@@ -155,6 +157,7 @@ public:
 	
 	Point render_size;
 	Point render_offset;
+	int render_mirror[8]; // direction drawn as this other direction mirrored, or -1
 
 	int anim_stance_position;
 	int anim_stance_frames;
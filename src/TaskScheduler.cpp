@@ -0,0 +1,257 @@
+/**
+ * class TaskScheduler
+ *
+ * A small pool of worker threads for engine work that can run side by side.
+ * Each thread has its own task deque; idle workers steal from the others.
+ * Tasks are counted in a TaskGroup, which can be waited on, and a task can
+ * be held back until another group has finished.
+ *
+ * With zero workers every task runs on the thread that waits for it. A
+ * negative count asks for one worker per core besides the calling thread.
+ *
+ * @license GPL
+ */
+
+#include "TaskScheduler.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+struct WorkerStart {
+	TaskScheduler *scheduler;
+	int index;
+};
+
+static WorkerStart worker_start[TASK_MAX_WORKERS];
+
+/**
+ * Cores besides the calling thread's, or 0 if the count is unknown
+ */
+static int spareCores() {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	int cores = (int)info.dwNumberOfProcessors;
+#else
+	int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (cores < 1) return 0;
+	return cores - 1;
+}
+
+TaskScheduler::TaskScheduler(int workers) {
+	if (workers < 0) workers = spareCores();
+	if (workers > TASK_MAX_WORKERS) workers = TASK_MAX_WORKERS;
+	
+	lock = SDL_CreateMutex();
+	work = SDL_CreateCond();
+	done = SDL_CreateCond();
+	queued = 0;
+	quit = false;
+	
+	for (int i=0; i<=TASK_MAX_WORKERS; i++) {
+		queues[i].top = 0;
+		queues[i].bottom = 0;
+		queues[i].lock = SDL_CreateMutex();
+	}
+	
+	worker_count = 0;
+	for (int i=0; i<workers; i++) {
+		worker_start[i].scheduler = this;
+		worker_start[i].index = i+1;
+		threads[i] = SDL_CreateThread(workerMain, &worker_start[i]);
+		if (!threads[i]) {
+			fprintf(stderr, "Couldn't start worker thread: %s\n", SDL_GetError());
+			break;
+		}
+		thread_ids[i] = SDL_GetThreadID(threads[i]);
+		worker_count++;
+	}
+}
+
+int TaskScheduler::workerMain(void *arg) {
+	WorkerStart *start = (WorkerStart *)arg;
+	TaskScheduler *s = start->scheduler;
+	Task t;
+	
+	while (true) {
+		SDL_LockMutex(s->lock);
+		while (!s->quit && s->queued == 0)
+			SDL_CondWait(s->work, s->lock);
+		bool stop = s->quit;
+		SDL_UnlockMutex(s->lock);
+		if (stop) break;
+		
+		if (s->take(start->index, t)) s->execute(t);
+	}
+	return 0;
+}
+
+/**
+ * The deque owned by the calling thread
+ */
+int TaskScheduler::currentQueue() {
+	Uint32 id = SDL_ThreadID();
+	for (int i=0; i<worker_count; i++) {
+		if (thread_ids[i] == id) return i+1;
+	}
+	return 0;
+}
+
+void TaskScheduler::push(const Task &t) {
+	TaskDeque *q = &queues[currentQueue()];
+	
+	SDL_LockMutex(q->lock);
+	if (q->bottom - q->top == TASK_QUEUE_SIZE) {
+		// full; do it now rather than drop it
+		SDL_UnlockMutex(q->lock);
+		execute(t);
+		return;
+	}
+	q->tasks[q->bottom & (TASK_QUEUE_SIZE-1)] = t;
+	q->bottom++;
+	SDL_UnlockMutex(q->lock);
+	
+	SDL_LockMutex(lock);
+	queued++;
+	SDL_CondSignal(work);
+	SDL_CondBroadcast(done);
+	SDL_UnlockMutex(lock);
+}
+
+/**
+ * Newest task from our own deque, else the oldest from someone else's
+ */
+bool TaskScheduler::take(int self, Task &t) {
+	bool found = false;
+	
+	for (int i=0; i<=worker_count && !found; i++) {
+		TaskDeque *q = &queues[(self + i) % (worker_count + 1)];
+		SDL_LockMutex(q->lock);
+		if (q->bottom > q->top) {
+			if (i == 0) {
+				q->bottom--;
+				t = q->tasks[q->bottom & (TASK_QUEUE_SIZE-1)];
+			}
+			else {
+				t = q->tasks[q->top & (TASK_QUEUE_SIZE-1)];
+				q->top++;
+			}
+			found = true;
+		}
+		SDL_UnlockMutex(q->lock);
+	}
+	
+	if (found) {
+		SDL_LockMutex(lock);
+		queued--;
+		SDL_UnlockMutex(lock);
+	}
+	return found;
+}
+
+/**
+ * Run a task, then release anything that was waiting on its group
+ */
+void TaskScheduler::execute(const Task &t) {
+	t.fn(t.data, t.begin, t.end);
+	if (!t.group) return;
+	
+	Task released[TASK_GROUP_PARKED];
+	int released_count = 0;
+	
+	SDL_LockMutex(lock);
+	t.group->pending--;
+	if (t.group->pending == 0) {
+		for (int i=0; i<t.group->parked_count; i++)
+			released[released_count++] = t.group->parked[i];
+		t.group->parked_count = 0;
+	}
+	SDL_CondBroadcast(done);
+	SDL_UnlockMutex(lock);
+	
+	for (int i=0; i<released_count; i++)
+		push(released[i]);
+}
+
+/**
+ * Queue fn(data, 0, 1) as one task in group.
+ * If after is given, the task doesn't start until that group has finished.
+ */
+void TaskScheduler::run(TaskFunction fn, void *data, TaskGroup *group, TaskGroup *after) {
+	parallelFor(fn, data, 1, 1, group, after);
+}
+
+/**
+ * Split [0, count) into tasks of about grain items each
+ */
+void TaskScheduler::parallelFor(TaskFunction fn, void *data, int count, int grain, TaskGroup *group, TaskGroup *after) {
+	if (grain < 1) grain = 1;
+	
+	for (int begin=0; begin<count; begin+=grain) {
+		Task t;
+		t.fn = fn;
+		t.data = data;
+		t.begin = begin;
+		t.end = begin + grain;
+		if (t.end > count) t.end = count;
+		t.group = group;
+		
+		SDL_LockMutex(lock);
+		if (group) group->pending++;
+		bool parked = false;
+		if (after && after->pending > 0 && after->parked_count < TASK_GROUP_PARKED) {
+			after->parked[after->parked_count++] = t;
+			parked = true;
+		}
+		bool blocked = !parked && after && after->pending > 0;
+		SDL_UnlockMutex(lock);
+		
+		if (parked) continue;
+		if (blocked) wait(after); // no room to park it
+		push(t);
+	}
+}
+
+/**
+ * Help run queued tasks until every task in group has finished
+ */
+void TaskScheduler::wait(TaskGroup *group) {
+	int self = currentQueue();
+	Task t;
+	
+	SDL_LockMutex(lock);
+	while (group->pending > 0) {
+		if (queued > 0) {
+			SDL_UnlockMutex(lock);
+			if (take(self, t)) execute(t);
+			SDL_LockMutex(lock);
+		}
+		else {
+			SDL_CondWait(done, lock);
+		}
+	}
+	SDL_UnlockMutex(lock);
+}
+
+TaskScheduler::~TaskScheduler() {
+	SDL_LockMutex(lock);
+	quit = true;
+	SDL_CondBroadcast(work);
+	SDL_UnlockMutex(lock);
+	
+	for (int i=0; i<worker_count; i++) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+	
+	for (int i=0; i<=TASK_MAX_WORKERS; i++) {
+		SDL_DestroyMutex(queues[i].lock);
+	}
+	SDL_DestroyCond(work);
+	SDL_DestroyCond(done);
+	SDL_DestroyMutex(lock);
+}
@@ -0,0 +1,91 @@
+/**
+ * class TaskScheduler
+ *
+ * A small pool of worker threads for engine work that can run side by side.
+ * Each thread has its own task deque; idle workers steal from the others.
+ * Tasks are counted in a TaskGroup, which can be waited on, and a task can
+ * be held back until another group has finished.
+ *
+ * With zero workers every task runs on the thread that waits for it. A
+ * negative count asks for one worker per core besides the calling thread.
+ *
+ * @license GPL
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+const int TASK_MAX_WORKERS = 15;
+const int TASK_QUEUE_SIZE = 1024; // per thread, power of two
+const int TASK_GROUP_PARKED = 16; // tasks that can wait on one group
+
+// work on items [begin, end) of whatever data points to
+typedef void (*TaskFunction)(void *data, int begin, int end);
+
+struct TaskGroup;
+
+struct Task {
+	TaskFunction fn;
+	void *data;
+	int begin;
+	int end;
+	TaskGroup *group;
+};
+
+/**
+ * Tasks still to finish, and tasks waiting for them to finish
+ */
+struct TaskGroup {
+	int pending;
+	Task parked[TASK_GROUP_PARKED];
+	int parked_count;
+	
+	TaskGroup() {
+		pending = 0;
+		parked_count = 0;
+	}
+};
+
+struct TaskDeque {
+	Task tasks[TASK_QUEUE_SIZE];
+	int top; // thieves take from here
+	int bottom; // the owner pushes and pops here
+	SDL_mutex *lock;
+};
+
+class TaskScheduler {
+private:
+	int worker_count;
+	SDL_Thread *threads[TASK_MAX_WORKERS];
+	Uint32 thread_ids[TASK_MAX_WORKERS];
+	
+	// deque 0 belongs to the main thread (and any other non-worker thread)
+	TaskDeque queues[TASK_MAX_WORKERS+1];
+	
+	SDL_mutex *lock; // guards queued, quit and every TaskGroup
+	SDL_cond *work; // signalled when a task is queued
+	SDL_cond *done; // broadcast when a task is queued or finished
+	int queued;
+	bool quit;
+	
+	static int workerMain(void *arg);
+	int currentQueue();
+	void push(const Task &t);
+	bool take(int self, Task &t);
+	void execute(const Task &t);
+
+public:
+	TaskScheduler(int workers);
+	~TaskScheduler();
+	
+	void run(TaskFunction fn, void *data, TaskGroup *group, TaskGroup *after = NULL);
+	void parallelFor(TaskFunction fn, void *data, int count, int grain, TaskGroup *group, TaskGroup *after = NULL);
+	void wait(TaskGroup *group);
+	
+	int workers() { return worker_count; }
+};
+
+#endif
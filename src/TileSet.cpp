@@ -29,12 +29,8 @@ void TileSet::loadGraphics(string filename) {
 		fprintf(stderr, "Couldn't load image: %s\n", IMG_GetError());
 		SDL_Quit();
 	}
-	SDL_SetColorKey( sprites, SDL_SRCCOLORKEY, SDL_MapRGB(sprites->format, 255, 0, 255) ); 
-	
 	// optimize
-	SDL_Surface *cleanup = sprites;
-	sprites = SDL_DisplayFormatAlpha(sprites);
-	SDL_FreeSurface(cleanup);	
+	sprites = image_loader.optimize(sprites, "images/tilesets/" + filename, true);
 }
 
 void TileSet::load(string filename) {
@@ -16,6 +16,7 @@
 #include "SDL.h"
 #include "SDL_image.h"
 #include "Utils.h"
+#include "ImageLoader.h"
 #include "UtilsParsing.h"
 
 using namespace std;
@@ -99,7 +99,7 @@ bool isWithin(SDL_Rect r, Point target) {
  */
 void zsort(Renderable r[], int rnum) {
 
-	int zpos[1024];
+	int zpos[MAX_RENDERABLES];
 	int ztemp;
 	Renderable rtemp;
 	
@@ -133,7 +133,7 @@ void sort_by_tile(Renderable r[], int rnum) {
 
 	// For MapIso the sort order is:
 	// tile column first, then tile row.  Within each tile, z-order
-	int zpos[1024];
+	int zpos[MAX_RENDERABLES];
 	int ztemp;
 	Renderable rtemp;
 	
@@ -198,3 +198,105 @@ void drawPixel(SDL_Surface *screen, int x, int y, Uint32 color) {
 	*pixmem32 = color;
 }
 
+/**
+ * Create a transparent surface in the same format as the given image.
+ * Menus render into one of these and blit it each frame, redrawing
+ * only when the state they show changes.
+ */
+SDL_Surface *createPanel(SDL_Surface *format_source, int w, int h) {
+	SDL_PixelFormat *fmt = format_source->format;
+	
+	// an opaque or colorkeyed source still needs an alpha channel here
+	Uint32 amask = fmt->Amask;
+	if (amask == 0 && fmt->BitsPerPixel == 32) amask = ~(fmt->Rmask | fmt->Gmask | fmt->Bmask);
+	
+	SDL_Surface *panel = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, amask);
+	if (!panel) {
+		fprintf(stderr, "Couldn't create panel surface: %s\n", SDL_GetError());
+		return NULL;
+	}
+	SDL_SetAlpha(panel, SDL_SRCALPHA, 255);
+	return panel;
+}
+
+/**
+ * Copy a menu background into a panel, alpha channel included.
+ * An alpha blit onto RGBA keeps the destination alpha, which would leave
+ * the panel transparent; everything drawn on top can blend normally.
+ * Opaque and colorkey backgrounds copy as they are, so only per-pixel
+ * alpha is switched off for the copy, and then back on.
+ */
+void blitPanelBackground(SDL_Surface *background, SDL_Rect *src, SDL_Surface *panel, SDL_Rect *dest) {
+	SDL_FillRect(panel, NULL, 0);
+	
+	Uint32 alpha_flag = background->flags & SDL_SRCALPHA;
+	Uint8 alpha = background->format->alpha;
+	if (alpha_flag) SDL_SetAlpha(background, 0, 255);
+	SDL_BlitSurface(background, src, panel, dest);
+	if (alpha_flag) SDL_SetAlpha(background, SDL_SRCALPHA, alpha);
+}
+
+/**
+ * Alpha-composite an image onto a panel.
+ * SDL keeps the destination alpha when blitting onto RGBA, so anything
+ * drawn over a clear or translucent part of the panel would vanish.
+ * "Over" gives the same result as blitting the layers one at a time onto
+ * the screen. Panels without their own alpha channel use a plain blit.
+ */
+void blitPanelLayer(SDL_Surface *image, SDL_Rect *src, SDL_Surface *panel, SDL_Rect *dest) {
+	if (!image || !panel) return;
+	if (panel->format->Amask == 0 || panel->format->BytesPerPixel != 4 || image->format->BytesPerPixel != 4) {
+		fastBlit(image, src, panel, dest);
+		return;
+	}
+	
+	SDL_Rect area;
+	if (src) area = *src;
+	else {
+		area.x = area.y = 0;
+		area.w = image->w;
+		area.h = image->h;
+	}
+	int x = dest ? dest->x : 0;
+	int y = dest ? dest->y : 0;
+	
+	bool keyed = (image->flags & SDL_SRCCOLORKEY) != 0;
+	Uint32 key = image->format->colorkey;
+	int surface_alpha = (image->flags & SDL_SRCALPHA) && image->format->Amask == 0 ? image->format->alpha : 255;
+	
+	Uint32 *src_pixel;
+	Uint32 *dest_pixel;
+	Uint8 sr, sg, sb, sa;
+	Uint8 dr, dg, db, da;
+	int out_a;
+	
+	if (SDL_MUSTLOCK(image)) SDL_LockSurface(image);
+	if (SDL_MUSTLOCK(panel)) SDL_LockSurface(panel);
+	
+	for (int j=0; j<area.h; j++) {
+		if (y+j < 0 || y+j >= panel->h || area.y+j < 0 || area.y+j >= image->h) continue;
+		for (int i=0; i<area.w; i++) {
+			if (x+i < 0 || x+i >= panel->w || area.x+i < 0 || area.x+i >= image->w) continue;
+			
+			src_pixel = (Uint32*)image->pixels + (area.y+j) * (image->pitch/4) + area.x+i;
+			if (keyed && *src_pixel == key) continue;
+			SDL_GetRGBA(*src_pixel, image->format, &sr, &sg, &sb, &sa);
+			sa = sa * surface_alpha / 255;
+			if (sa == 0) continue;
+			
+			dest_pixel = (Uint32*)panel->pixels + (y+j) * (panel->pitch/4) + x+i;
+			SDL_GetRGBA(*dest_pixel, panel->format, &dr, &dg, &db, &da);
+			
+			da = da * (255-sa) / 255;
+			out_a = sa + da;
+			*dest_pixel = SDL_MapRGBA(panel->format,
+				(sr*sa + dr*da) / out_a,
+				(sg*sa + dg*da) / out_a,
+				(sb*sa + db*da) / out_a,
+				out_a);
+		}
+	}
+	
+	if (SDL_MUSTLOCK(panel)) SDL_UnlockSurface(panel);
+	if (SDL_MUSTLOCK(image)) SDL_UnlockSurface(image);
+}
@@ -15,6 +15,7 @@
 #include "SDL_image.h"
 #include "math.h"
 #include "Settings.h"
+#include "BlitKernels.h"
 
 using namespace std;
 
@@ -26,6 +27,9 @@ struct FPoint {
 	float x,y;
 };
 
+// most renderables drawn in one frame; the sorts below hold this many
+const int MAX_RENDERABLES = 1024;
+
 // message passing struct for various sprites rendered map inline
 struct Renderable {
 	Point map_pos;
@@ -33,6 +37,7 @@ struct Renderable {
 	SDL_Rect src;
 	Point offset;
 	bool object_layer;
+	bool flip; // draw src mirrored left to right
 	Point tile;
 };
 
@@ -61,6 +66,9 @@ bool isWithin(SDL_Rect r, Point target);
 void zsort(Renderable r[], int rnum);
 void sort_by_tile(Renderable r[], int rnum);
 void drawPixel(SDL_Surface *screen, int x, int y, Uint32 color);
+SDL_Surface *createPanel(SDL_Surface *format_source, int w, int h);
+void blitPanelBackground(SDL_Surface *background, SDL_Rect *src, SDL_Surface *panel, SDL_Rect *dest);
+void blitPanelLayer(SDL_Surface *image, SDL_Rect *src, SDL_Surface *panel, SDL_Rect *dest);
 
 /**
  * As implemented here:
@@ -35,9 +35,7 @@ void WidgetButton::loadArt() {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = buttons;
-	buttons = SDL_DisplayFormatAlpha(buttons);
-	SDL_FreeSurface(cleanup);
+	buttons = image_loader.optimize(buttons, "images/menus/buttons.png", false);
 	
 	
 }
@@ -97,7 +95,7 @@ void WidgetButton::render() {
 	else
 		src.y = BUTTON_GFX_NORMAL * pos.h;
 	
-	SDL_BlitSurface(buttons, &src, screen, &pos);
+	fastBlit(buttons, &src, screen, &pos);
 	
 	// render text
 	int font_color = FONT_WHITE;
@@ -0,0 +1,143 @@
+/**
+ * BlitKernelBench
+ *
+ * Times fastBlit against SDL_BlitSurface for the two formats the blit
+ * kernels take over, drawing the same sprites at the same positions onto
+ * two copies of a screen, then checks the copies are identical:
+ *   blit_kernel_bench
+ * Exits with 1 if any pixel differs.
+ *
+ * @license GPL
+ */
+
+#include "../BlitKernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const int BENCH_SCREEN_W = 640;
+const int BENCH_SCREEN_H = 480;
+const int BENCH_CELL = 64; // sprite sheet cell size
+const int BENCH_CELLS = 4; // cells per sheet row and column
+const int BENCH_BLITS = 100000;
+const Uint32 BENCH_KEY = 0xff00ff;
+
+/**
+ * 32-bit surface in the display format, with or without an alpha channel
+ */
+static SDL_Surface *createSurface(int w, int h, bool alpha) {
+	SDL_Surface *s = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+		0x00ff0000, 0x0000ff00, 0x000000ff, alpha ? 0xff000000 : 0);
+	if (!s) {
+		fprintf(stderr, "Couldn't create a %dx%d surface: %s\n", w, h, SDL_GetError());
+		exit(1);
+	}
+	return s;
+}
+
+/**
+ * Sprite sheet with the mix of pixels a trimmed sprite has: clear,
+ * opaque and partly transparent for alpha, keyed and solid otherwise
+ */
+static SDL_Surface *createSheet(bool alpha) {
+	int size = BENCH_CELL * BENCH_CELLS;
+	SDL_Surface *sheet = createSurface(size, size, alpha);
+
+	for (int y=0; y<size; y++) {
+		Uint32 *p = (Uint32 *)((Uint8 *)sheet->pixels + y * sheet->pitch);
+		for (int x=0; x<size; x++) {
+			Uint32 rgb = rand() & 0xffffff;
+			int kind = rand() % 4;
+			if (alpha) {
+				Uint32 a = (kind == 0) ? 0 : (kind == 1) ? 255 : rand() % 255;
+				p[x] = (a << 24) | rgb;
+			}
+			else {
+				p[x] = (kind == 0) ? BENCH_KEY : rgb;
+			}
+		}
+	}
+
+	if (alpha) SDL_SetAlpha(sheet, SDL_SRCALPHA, 255);
+	else SDL_SetColorKey(sheet, SDL_SRCCOLORKEY, BENCH_KEY);
+	return sheet;
+}
+
+/**
+ * Draw the seeded sequence of cells onto screen, returning the time taken.
+ * Positions run past every edge so clipping is covered too.
+ */
+static clock_t drawAll(SDL_Surface *sheet, SDL_Surface *screen, bool kernels) {
+	SDL_Rect src;
+	SDL_Rect dest;
+
+	srand(11);
+	clock_t start = clock();
+	for (int i=0; i<BENCH_BLITS; i++) {
+		src.x = (rand() % BENCH_CELLS) * BENCH_CELL;
+		src.y = (rand() % BENCH_CELLS) * BENCH_CELL;
+		src.w = src.h = BENCH_CELL;
+		dest.x = rand() % (BENCH_SCREEN_W + BENCH_CELL) - BENCH_CELL;
+		dest.y = rand() % (BENCH_SCREEN_H + BENCH_CELL) - BENCH_CELL;
+		if (kernels) fastBlit(sheet, &src, screen, &dest);
+		else SDL_BlitSurface(sheet, &src, screen, &dest);
+	}
+	return clock() - start;
+}
+
+/**
+ * Time one format both ways and compare the results. Returns the number
+ * of pixels that differ.
+ */
+static int benchFormat(const char *name, bool alpha) {
+	SDL_Surface *sheet = createSheet(alpha);
+	SDL_Surface *screens[2];
+
+	// the same noisy background, unused top byte included, under both
+	for (int i=0; i<2; i++) {
+		screens[i] = createSurface(BENCH_SCREEN_W, BENCH_SCREEN_H, false);
+		srand(7);
+		for (int y=0; y<BENCH_SCREEN_H; y++) {
+			Uint32 *p = (Uint32 *)((Uint8 *)screens[i]->pixels + y * screens[i]->pitch);
+			for (int x=0; x<BENCH_SCREEN_W; x++) {
+				p[x] = ((Uint32)rand() << 16) ^ (Uint32)rand();
+			}
+		}
+	}
+
+	if (blitKernel(sheet, screens[1]) == BLIT_KERNEL_SDL) {
+		fprintf(stderr, "%s: no blit kernel takes this format\n", name);
+		return 1;
+	}
+
+	clock_t sdl_time = drawAll(sheet, screens[0], false);
+	clock_t kernel_time = drawAll(sheet, screens[1], true);
+
+	int differ = 0;
+	for (int y=0; y<BENCH_SCREEN_H; y++) {
+		Uint32 *a = (Uint32 *)((Uint8 *)screens[0]->pixels + y * screens[0]->pitch);
+		Uint32 *b = (Uint32 *)((Uint8 *)screens[1]->pixels + y * screens[1]->pitch);
+		for (int x=0; x<BENCH_SCREEN_W; x++) {
+			if (a[x] != b[x]) differ++;
+		}
+	}
+
+	double pixels = (double)BENCH_BLITS * BENCH_CELL * BENCH_CELL;
+	printf("%s: SDL %.0f ms (%.0f Mpix/s), kernels %.0f ms (%.0f Mpix/s), %d pixels differ\n", name,
+		sdl_time * 1000.0 / CLOCKS_PER_SEC, pixels / 1e6 / ((double)sdl_time / CLOCKS_PER_SEC + 1e-9),
+		kernel_time * 1000.0 / CLOCKS_PER_SEC, pixels / 1e6 / ((double)kernel_time / CLOCKS_PER_SEC + 1e-9),
+		differ);
+
+	SDL_FreeSurface(sheet);
+	SDL_FreeSurface(screens[0]);
+	SDL_FreeSurface(screens[1]);
+	return differ;
+}
+
+int main(int, char *[]) {
+	int differ = 0;
+	differ += benchFormat("per-pixel alpha", true);
+	differ += benchFormat("colorkey", false);
+	return differ == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**
+ * FlipBlitTest
+ *
+ * Draws random cells of a sprite sheet mirrored through a BlitQueue, and
+ * the same cells of a pre-mirrored copy of the sheet with SDL_BlitSurface,
+ * then checks both screens are identical. Covers per-pixel alpha, colorkey
+ * and 8-bit palette sheets, with and without worker threads:
+ *   flip_blit_test
+ * Exits with 1 if any pixel differs.
+ *
+ * @license GPL
+ */
+
+#include "../BlitQueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int TEST_SCREEN_W = 320;
+const int TEST_SCREEN_H = 240;
+const int TEST_SHEET_W = 256;
+const int TEST_SHEET_H = 128;
+const int TEST_BLITS = 4000;
+const int TEST_FLUSH_EVERY = 500; // blits queued between flushes
+const Uint32 TEST_KEY = 0xff00ff;
+
+const int SHEET_ALPHA = 0;
+const int SHEET_COLORKEY = 1;
+const int SHEET_INDEXED = 2;
+
+static SDL_Surface *createSurface(int w, int h, int kind) {
+	SDL_Surface *s;
+	if (kind == SHEET_INDEXED)
+		s = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 8, 0, 0, 0, 0);
+	else
+		s = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+			0x00ff0000, 0x0000ff00, 0x000000ff, kind == SHEET_ALPHA ? 0xff000000 : 0);
+	if (!s) {
+		fprintf(stderr, "Couldn't create a %dx%d surface: %s\n", w, h, SDL_GetError());
+		exit(1);
+	}
+	return s;
+}
+
+/**
+ * Sheet of random pixels, about a quarter of them transparent
+ */
+static SDL_Surface *createSheet(int kind) {
+	SDL_Surface *sheet = createSurface(TEST_SHEET_W, TEST_SHEET_H, kind);
+
+	if (kind == SHEET_INDEXED) {
+		SDL_Color colors[256];
+		for (int i=0; i<256; i++) {
+			colors[i].r = rand() % 256;
+			colors[i].g = rand() % 256;
+			colors[i].b = rand() % 256;
+			colors[i].unused = 0;
+		}
+		SDL_SetColors(sheet, colors, 0, 256);
+	}
+
+	for (int y=0; y<TEST_SHEET_H; y++) {
+		Uint8 *row = (Uint8 *)sheet->pixels + y * sheet->pitch;
+		for (int x=0; x<TEST_SHEET_W; x++) {
+			bool clear = (rand() % 4 == 0);
+			if (kind == SHEET_INDEXED) {
+				row[x] = clear ? 0 : 1 + rand() % 255;
+			}
+			else if (kind == SHEET_COLORKEY) {
+				((Uint32 *)row)[x] = clear ? TEST_KEY : rand() & 0xffffff;
+			}
+			else {
+				Uint32 a = clear ? 0 : (rand() % 2) ? 255 : rand() % 255;
+				((Uint32 *)row)[x] = (a << 24) | (rand() & 0xffffff);
+			}
+		}
+	}
+
+	if (kind == SHEET_ALPHA) SDL_SetAlpha(sheet, SDL_SRCALPHA, 255);
+	else if (kind == SHEET_COLORKEY) SDL_SetColorKey(sheet, SDL_SRCCOLORKEY, TEST_KEY);
+	else SDL_SetColorKey(sheet, SDL_SRCCOLORKEY, 0);
+	return sheet;
+}
+
+/**
+ * The sheet mirrored left to right, same format, palette and key
+ */
+static SDL_Surface *mirrorSheet(SDL_Surface *sheet, int kind) {
+	SDL_Surface *mirror = createSurface(sheet->w, sheet->h, kind);
+	int bpp = sheet->format->BytesPerPixel;
+
+	if (kind == SHEET_INDEXED)
+		SDL_SetColors(mirror, sheet->format->palette->colors, 0, sheet->format->palette->ncolors);
+
+	for (int y=0; y<sheet->h; y++) {
+		Uint8 *from = (Uint8 *)sheet->pixels + y * sheet->pitch;
+		Uint8 *to = (Uint8 *)mirror->pixels + y * mirror->pitch;
+		for (int x=0; x<sheet->w; x++) {
+			memcpy(to + (sheet->w - 1 - x) * bpp, from + x * bpp, bpp);
+		}
+	}
+
+	if (sheet->flags & SDL_SRCALPHA) SDL_SetAlpha(mirror, SDL_SRCALPHA, 255);
+	if (sheet->flags & SDL_SRCCOLORKEY) SDL_SetColorKey(mirror, SDL_SRCCOLORKEY, sheet->format->colorkey);
+	return mirror;
+}
+
+static void fillNoise(SDL_Surface *screen) {
+	srand(5);
+	for (int y=0; y<screen->h; y++) {
+		Uint32 *p = (Uint32 *)((Uint8 *)screen->pixels + y * screen->pitch);
+		for (int x=0; x<screen->w; x++) {
+			p[x] = ((Uint32)rand() << 16) ^ (Uint32)rand();
+		}
+	}
+}
+
+/**
+ * Returns the number of pixels where the queue and the reference differ
+ */
+static int testSheet(const char *name, int kind, int workers) {
+	srand(kind + 1);
+	SDL_Surface *sheet = createSheet(kind);
+	SDL_Surface *mirror = mirrorSheet(sheet, kind);
+	SDL_Surface *flipped = createSurface(TEST_SCREEN_W, TEST_SCREEN_H, SHEET_COLORKEY);
+	SDL_Surface *reference = createSurface(TEST_SCREEN_W, TEST_SCREEN_H, SHEET_COLORKEY);
+	fillNoise(flipped);
+	fillNoise(reference);
+
+	TaskScheduler *tasks = new TaskScheduler(workers);
+	BlitQueue *queue = new BlitQueue(flipped, tasks);
+
+	SDL_Rect src;
+	SDL_Rect mirror_src;
+	SDL_Rect dest;
+	srand(17);
+	for (int i=0; i<TEST_BLITS; i++) {
+		src.w = 1 + rand() % 64;
+		src.h = 1 + rand() % 64;
+		src.x = rand() % (TEST_SHEET_W - src.w + 1);
+		src.y = rand() % (TEST_SHEET_H - src.h + 1);
+		dest.x = rand() % (TEST_SCREEN_W + 64) - 64;
+		dest.y = rand() % (TEST_SCREEN_H + 64) - 64;
+
+		mirror_src = src;
+		mirror_src.x = TEST_SHEET_W - src.x - src.w;
+
+		queue->blit(sheet, &src, &dest, true);
+		SDL_BlitSurface(mirror, &mirror_src, reference, &dest);
+
+		if ((i+1) % TEST_FLUSH_EVERY == 0) queue->flush();
+	}
+	queue->flush();
+
+	int differ = 0;
+	for (int y=0; y<TEST_SCREEN_H; y++) {
+		Uint32 *a = (Uint32 *)((Uint8 *)flipped->pixels + y * flipped->pitch);
+		Uint32 *b = (Uint32 *)((Uint8 *)reference->pixels + y * reference->pitch);
+		for (int x=0; x<TEST_SCREEN_W; x++) {
+			if (a[x] != b[x]) differ++;
+		}
+	}
+	printf("%s, %d workers: %d pixels differ\n", name, workers, differ);
+
+	delete queue;
+	delete tasks;
+	SDL_FreeSurface(sheet);
+	SDL_FreeSurface(mirror);
+	SDL_FreeSurface(flipped);
+	SDL_FreeSurface(reference);
+	return differ;
+}
+
+int main(int, char *[]) {
+	int differ = 0;
+	for (int workers = 0; workers <= 2; workers += 2) {
+		differ += testSheet("per-pixel alpha", SHEET_ALPHA, workers);
+		differ += testSheet("colorkey", SHEET_COLORKEY, workers);
+		differ += testSheet("8-bit palette", SHEET_INDEXED, workers);
+	}
+	return differ == 0 ? 0 : 1;
+}
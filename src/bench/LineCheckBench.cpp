@@ -0,0 +1,174 @@
+/**
+ * LineCheckBench
+ *
+ * Times MapCollision::line_check against the per-unit stepping it replaced,
+ * on the collision layers of the shipped maps, and reports how often the
+ * two agree. Run from the game directory:
+ *   line_check_bench [map files...]
+ *
+ * @license GPL
+ */
+
+#include "../MapCollision.h"
+#include "../UtilsParsing.h"
+#include <stdio.h>
+#include <time.h>
+
+const int BENCH_LINES = 200000; // per map and check type
+const int BENCH_REACH = 640; // longest line, in map units
+
+static const char *default_maps[] = {
+	"maps/averguard_academy.txt",
+	"maps/averguard_atrium.txt",
+	"maps/averguard_complex.txt",
+	"maps/averguard_prison.txt",
+	"maps/averguard_temple.txt",
+	"maps/cave1.txt",
+	"maps/goblin_warrens.txt",
+	"maps/lost_mines1.txt"
+};
+
+static unsigned short colmap[256][256];
+
+/**
+ * The previous line_check: one map unit per step, in floating point
+ */
+static bool steppedLineCheck(MapCollision *collider, int x1, int y1, int x2, int y2, int checktype) {
+	float x = (float)x1;
+	float y = (float)y1;
+	float dx = (float)abs(x2 - x1);
+	float dy = (float)abs(y2 - y1);
+	float step_x;
+	float step_y;
+	int steps = (int)max(dx, dy);
+
+	if (dx > dy) {
+		step_x = 1;
+		step_y = dy / dx;
+	}
+	else {
+		step_y = 1;
+		step_x = dx / dy;
+	}
+	if (x1 > x2) step_x = -step_x;
+	if (y1 > y2) step_y = -step_y;
+
+	for (int i=0; i<steps; i++) {
+		x += step_x;
+		y += step_y;
+		bool blocked;
+		if (checktype == CHECK_SIGHT) blocked = collider->is_wall(round(x), round(y));
+		else blocked = !collider->is_empty(round(x), round(y));
+		if (blocked) return false;
+	}
+	return true;
+}
+
+/**
+ * Read the collision layer of a map file. Returns false if it has none.
+ */
+static bool loadCollision(const char *filename, Point &size) {
+	ifstream infile;
+	string line, key, val, section, layer;
+	
+	infile.open(filename, ios::in);
+	if (!infile.is_open()) return false;
+	
+	size.x = size.y = 0;
+	while (!infile.eof()) {
+		line = getLine(infile);
+		if (line.length() == 0 || line[0] == '#') continue;
+		if (line[0] == '[') {
+			section = parse_section_title(line);
+			continue;
+		}
+		parse_key_pair(line, key, val);
+		if (section == "header" && key == "width") size.x = atoi(val.c_str());
+		else if (section == "header" && key == "height") size.y = atoi(val.c_str());
+		else if (section == "layer" && key == "id") layer = val;
+		else if (section == "layer" && key == "data" && layer == "collision") {
+			for (int j=0; j<size.y; j++) {
+				line = getLine(infile) + ',';
+				for (int i=0; i<size.x; i++) colmap[i][j] = eatFirstInt(line, ',');
+			}
+			infile.close();
+			return size.x > 0 && size.y > 0;
+		}
+	}
+	infile.close();
+	return false;
+}
+
+int main(int argc, char *argv[]) {
+	MapCollision *collider = new MapCollision();
+	int *lines = new int[BENCH_LINES * 4];
+	bool *stepped_clear = new bool[BENCH_LINES];
+	
+	int map_count = argc > 1 ? argc - 1 : sizeof(default_maps) / sizeof(default_maps[0]);
+	long total = 0;
+	long same = 0;
+	clock_t stepped_ticks = 0;
+	clock_t dda_ticks = 0;
+	
+	for (int m=0; m<map_count; m++) {
+		const char *filename = argc > 1 ? argv[m+1] : default_maps[m];
+		Point size;
+		if (!loadCollision(filename, size)) {
+			fprintf(stderr, "Couldn't read the collision layer of %s\n", filename);
+			continue;
+		}
+		collider->setmap(colmap);
+		collider->map_size = size;
+		
+		// lines start on walkable ground and reach up to BENCH_REACH in any direction
+		srand(7);
+		for (int k=0; k<BENCH_LINES; k++) {
+			int x, y;
+			do {
+				x = rand() % (size.x * UNITS_PER_TILE);
+				y = rand() % (size.y * UNITS_PER_TILE);
+			} while (!collider->is_empty(x, y));
+			lines[k*4] = x;
+			lines[k*4+1] = y;
+			lines[k*4+2] = x + rand() % (2*BENCH_REACH+1) - BENCH_REACH;
+			lines[k*4+3] = y + rand() % (2*BENCH_REACH+1) - BENCH_REACH;
+		}
+		
+		for (int checktype = CHECK_MOVEMENT; checktype <= CHECK_SIGHT; checktype++) {
+			clock_t start = clock();
+			for (int k=0; k<BENCH_LINES; k++) {
+				int *l = lines + k*4;
+				stepped_clear[k] = steppedLineCheck(collider, l[0], l[1], l[2], l[3], checktype);
+			}
+			stepped_ticks += clock() - start;
+			
+			start = clock();
+			for (int k=0; k<BENCH_LINES; k++) {
+				int *l = lines + k*4;
+				bool clear;
+				if (checktype == CHECK_SIGHT) clear = collider->line_of_sight(l[0], l[1], l[2], l[3]);
+				else clear = collider->line_of_movement(l[0], l[1], l[2], l[3]);
+				if (clear == stepped_clear[k]) same++;
+			}
+			dda_ticks += clock() - start;
+			total += BENCH_LINES;
+		}
+	}
+	
+	if (total == 0) {
+		fprintf(stderr, "No maps to test; run from the game directory\n");
+		return 1;
+	}
+	
+	printf("%ld lines on %d maps\n", total, map_count);
+	printf("stepped: %.0f ms\n", stepped_ticks * 1000.0 / CLOCKS_PER_SEC);
+	printf("grid walk: %.0f ms\n", dda_ticks * 1000.0 / CLOCKS_PER_SEC);
+	printf("same answer: %.2f%%\n", same * 100.0 / total);
+	
+	delete[] lines;
+	delete[] stepped_clear;
+	delete collider;
+	
+	// the two only differ on lines that graze a wall corner
+	return (same * 100 < total * 99) ? 1 : 0;
+}
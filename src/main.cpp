@@ -17,6 +17,7 @@ using namespace std;
 #include "Settings.h"
 #include "InputState.h"
 #include "GameSwitcher.h"
+#include "ImageLoader.h"
 
 SDL_Surface *screen;
 InputState *inps;
@@ -117,6 +118,8 @@ int main(int argc, char *argv[])
 	init();
 	mainLoop();
 	
+	if (SHOW_FPS) image_loader.report();
+	
 	// cleanup
 	// TODO: halt all sounds here before freeing music/chunks
 	delete(gswitch);